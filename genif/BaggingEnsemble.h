@@ -1,9 +1,17 @@
 #ifndef GENIF_BAGGINGENSEMBLE_H
 #define GENIF_BAGGINGENSEMBLE_H
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <functional>
 #include <genif/Learner.h>
-#include <random>
+#include <genif/Tools.h>
+#include <genif/io/RowReader.h>
+#include <genif/random/Philox.h>
+#include <iterator>
+#include <limits>
+#include <queue>
 
 namespace genif {
     /**
@@ -11,9 +19,10 @@ namespace genif {
      *
      * @tparam ModelType The type of model, that the learner yields as result from calling `fit`.
      * @tparam PredictionType The type of prediction, that the learner yields as result from calling either `fitPredict` and `predict`.
+     * @tparam T The scalar type of the datasets (float or double).
      */
-    template<typename ModelType, typename PredictionType>
-    class BaggingEnsemble : public Learner<std::vector<ModelType>, std::vector<PredictionType>> {
+    template<typename ModelType, typename PredictionType, typename T>
+    class BaggingEnsemble : public Learner<std::vector<ModelType>, std::vector<PredictionType>, T> {
     public:
         /**
          * Constructs a new instance of BaggingEnsemble.
@@ -21,10 +30,10 @@ namespace genif {
          * @param baseLearner The base learner, which serves as a prototype for subsequent learning efforts.
          * @param nModels The number of models to fit.
          * @param sampleSize The number of observations to draw to fit each model.
-         * @param workerCount The number of workers, which should fit models in parallel.
+         * @param workerCount The number of workers, which should fit models in parallel. This is the overall budget, which is shared by all models.
          * @param seed Seed to use for random number generation (-1 defaults to sysclock seed). Pass an integer for constant result across multiple runs.
          */
-        explicit BaggingEnsemble(const Learner<ModelType, PredictionType>& baseLearner, unsigned int nModels = 100, unsigned int sampleSize = 256, unsigned int workerCount = 1,
+        explicit BaggingEnsemble(const Learner<ModelType, PredictionType, T>& baseLearner, unsigned int nModels = 100, unsigned int sampleSize = 256, unsigned int workerCount = 1,
                                  int seed = -1) :
             _baseLearner(baseLearner), _seed(seed) {
             // Check property validity.
@@ -39,43 +48,120 @@ namespace genif {
             _nModels = nModels;
             _sampleSize = sampleSize;
             _workerCount = workerCount;
+            _streamSeed = resolveSeed();
         }
 
         /**
          * Fit `nModels` using the supplied dataset.
          *
-         * For fitting, this method takes a copy of the baseLearner property and calls fit using a previously drawn sample of dataset.
+         * For fitting, this method takes a copy of the baseLearner property and calls fit using the row indices of a previously drawn sample of dataset.
          *
          * @param dataset The dataset used to fit models.
          * @return A reference to the current BaggingEnsemble instance. The fitted models may be retrieved by calling the `getModels()` function.
          */
-        Learner<std::vector<ModelType>, std::vector<PredictionType>>& fit(const MatrixX& dataset) override {
-            // Create PRNG.
-            std::default_random_engine generator(_seed >= 0 ? _seed : std::chrono::system_clock::now().time_since_epoch().count());
-            std::uniform_int_distribution<int> distribution(0, dataset.rows() - 1);
+        Learner<std::vector<ModelType>, std::vector<PredictionType>, T>& fit(const RowMatrixXRef<T>& dataset) override {
+            // Replace all existing models.
+            _streamSeed = resolveSeed();
+            _models = fitModels(dataset, 0, _nModels);
+            _nextModelIndex = _nModels;
+            _nObservations = dataset.rows();
 
-            // Remove all existing models.
-            _models.clear();
+            // Return self.
+            return *this;
+        }
 
-            // Estimate new models.
-#pragma omp parallel for ordered num_threads(_workerCount)
-            for (unsigned int i = 0; i < _nModels; i++) {
-                // Take a copy of the base learner.
-                auto learnerCopy = _baseLearner.copy();
+        /**
+         * Fits additional models and appends them to the existing ones, which are not changed.
+         *
+         * The models continue the random streams of `fit`, i.e. the i-th model, which is fitted after `fit`, uses the stream of model `nModels + i`. Hence, fitting
+         * `nModels` models and adding `n` models yields the same models as fitting `nModels + n` models at once (for the same seed and dataset).
+         *
+         * @param dataset The dataset used to fit the models.
+         * @param nModels The number of models to add.
+         * @return A reference to the current BaggingEnsemble instance.
+         */
+        Learner<std::vector<ModelType>, std::vector<PredictionType>, T>& addModels(const RowMatrixXRef<T>& dataset, unsigned int nModels) {
+            std::vector<ModelType> models = fitModels(dataset, _nextModelIndex, nModels);
+            _nextModelIndex += nModels;
+            _nObservations = dataset.rows();
+            _models.insert(_models.end(), std::make_move_iterator(models.begin()), std::make_move_iterator(models.end()));
+            return *this;
+        }
 
-                // Sample dataset with replacement.
-                MatrixX sampledDataset(_sampleSize, dataset.cols());
-                for (unsigned int j = 0; j < _sampleSize; j++)
-#pragma omp ordered
-                    sampledDataset.row(j) = dataset.row(distribution(generator));
+        /**
+         * Replaces selected models by newly fitted ones (e.g. the oldest ones). The new models continue the random streams like `addModels`, all other models are not
+         * changed.
+         *
+         * @param dataset The dataset used to fit the models.
+         * @param modelIndices The positions of the models to replace.
+         * @return A reference to the current BaggingEnsemble instance.
+         */
+        Learner<std::vector<ModelType>, std::vector<PredictionType>, T>& replaceModels(const RowMatrixXRef<T>& dataset, const std::vector<unsigned int>& modelIndices) {
+            for (unsigned int index : modelIndices)
+                if (index >= _models.size())
+                    throw std::runtime_error("BaggingEnsemble::replaceModels: Model index " + std::to_string(index) + " is out of range.");
 
-                // Fit base learner with sampled dataset.
-                learnerCopy->fit(sampledDataset);
+            std::vector<ModelType> models = fitModels(dataset, _nextModelIndex, modelIndices.size());
+            _nextModelIndex += modelIndices.size();
+            _nObservations = dataset.rows();
+            for (size_t i = 0; i < modelIndices.size(); i++)
+                _models[modelIndices[i]] = std::move(models[i]);
+            return *this;
+        }
 
-                // Add estimated model to the models vector.
-#pragma omp critical
-                _models.push_back(std::move(learnerCopy->getModel()));
-            }
+        /**
+         * Draws `nModels` samples of the dataset and calls a function with a prepared copy of the base learner for every sample. The samples and the seeds of the learner
+         * copies are the same as for `fit`, hence the function may fit the learners in a different way (e.g. for multiple parameter values at once) and still sees the
+         * same data.
+         *
+         * @tparam ResultType The type of the result of a single call.
+         * @tparam FitFunction A function, which is callable as `ResultType(Learner<ModelType, PredictionType, T>& learner, const std::vector<unsigned int>& sampleIndices)`.
+         * @param dataset The dataset to draw the samples from.
+         * @param fitFunction The function to call for every sample. It is called concurrently by multiple workers.
+         * @return The results of the calls in the order of the models.
+         */
+        template<typename ResultType, typename FitFunction>
+        std::vector<ResultType> fitSamples(const RowMatrixXRef<T>& dataset, FitFunction fitFunction) const {
+            const std::uint64_t seed = resolveSeed();
+            const auto nObservations = static_cast<std::uint32_t>(dataset.rows());
+            return fitEachModel<ResultType>(
+                _nModels, [this, seed, nObservations](unsigned int i, std::vector<unsigned int>& sampleIndices) { return drawSample(seed, i, nObservations, sampleIndices); },
+                fitFunction);
+        }
+
+        /**
+         * Fit `nModels` using rows, which are read from a source (e.g. a file, see RowReader), which may be far larger than the memory. Only the sampled rows are
+         * materialized, all models are then fitted on them.
+         *
+         * If the source knows its number of rows, the samples are drawn exactly as by `fit` and the sampled rows are gathered in a single forward pass, which skips all
+         * other rows (e.g. by seeking in a file). Hence, the models equal the models of `fit` on the whole dataset for the same seed. Otherwise, every entry of every
+         * sample is drawn by reservoir sampling during a single pass over the source, which yields uniform samples with replacement as well, but not the same samples as
+         * `fit`.
+         *
+         * @param reader The source of the rows.
+         * @return A reference to the current BaggingEnsemble instance. The fitted models may be retrieved by calling the `getModels()` function.
+         */
+        Learner<std::vector<ModelType>, std::vector<PredictionType>, T>& fit(RowReader<T>& reader) {
+            _streamSeed = resolveSeed();
+            std::vector<int> learnerSeeds(_nModels);
+            std::vector<std::vector<unsigned int>> samples(_nModels);
+            _nObservations = reader.getNumberOfRows();
+            const RowMatrixX<T> rows = _nObservations != RowReader<T>::unknownNumberOfRows ? gatherSamples(reader, _streamSeed, learnerSeeds, samples)
+                                                                                           : reservoirSamples(reader, _streamSeed, learnerSeeds, samples, _nObservations);
+            const RowMatrixXRef<T> dataset(rows);
+
+            // Replace all existing models.
+            _nextModelIndex = _nModels;
+            _models = fitEachModel<ModelType>(
+                _nModels,
+                [&learnerSeeds, &samples](unsigned int i, std::vector<unsigned int>& sampleIndices) {
+                    sampleIndices.swap(samples[i]);
+                    return learnerSeeds[i];
+                },
+                [&dataset](Learner<ModelType, PredictionType, T>& learner, const std::vector<unsigned int>& sampleIndices) {
+                    learner.fit(dataset, sampleIndices);
+                    return learner.getModel();
+                });
 
             // Return self.
             return *this;
@@ -89,7 +175,7 @@ namespace genif {
          * @param dataset The dataset to use for prediction.
          * @return A vector of predictions.
          */
-        std::vector<PredictionType> predict(const MatrixX& dataset) const override {
+        std::vector<PredictionType> predict(const RowMatrixXRef<T>& dataset) const override {
             // Create vector of predictions.
             std::vector<PredictionType> predictions;
             predictions.reserve(_models.size());
@@ -109,6 +195,64 @@ namespace genif {
             return _models;
         }
 
+        /**
+         * Gathers the list of learned models without copying them.
+         * @return A const reference to the list of models.
+         */
+        const std::vector<ModelType>& getModels() const {
+            return _models;
+        }
+
+        /**
+         * Replaces the list of models (e.g. by updated models).
+         * @param models The new models.
+         */
+        void setModels(std::vector<ModelType> models) {
+            _models = std::move(models);
+        }
+
+        /**
+         * Returns the index of the random stream, which the next added model will use (see `addModels`).
+         * @return As stated above.
+         */
+        unsigned int getNextModelIndex() const {
+            return _nextModelIndex;
+        }
+
+        /**
+         * Sets the index of the random stream, which the next added model will use, e.g. to continue the streams of a restored ensemble.
+         * @param nextModelIndex As stated above.
+         */
+        void setNextModelIndex(unsigned int nextModelIndex) {
+            _nextModelIndex = nextModelIndex;
+        }
+
+        /**
+         * Sets the number of workers, which fit the models. This is the overall budget, which is shared by all models.
+         * @param workerCount The number of workers.
+         */
+        void setWorkerCount(unsigned int workerCount) override {
+            if (workerCount <= 0)
+                throw std::runtime_error("BaggingEnsemble::setWorkerCount: workerCount needs to be greater than zero.");
+            _workerCount = workerCount;
+        }
+
+        /**
+         * Returns the number of observations of the dataset, which the latest models have been fitted on (by `fit`, `addModels` or `replaceModels`).
+         * @return As stated above.
+         */
+        std::uint64_t getNumberOfObservations() const {
+            return _nObservations;
+        }
+
+        /**
+         * Sets the number of observations of the dataset, which the models represent, e.g. for a restored or merged ensemble.
+         * @param nObservations As stated above.
+         */
+        void setNumberOfObservations(std::uint64_t nObservations) {
+            _nObservations = nObservations;
+        }
+
         /**
          * Returns the number of models, which should be fitted in this ensemble.
          * @return As stated above.
@@ -126,11 +270,241 @@ namespace genif {
         }
 
     private:
-        const Learner<ModelType, PredictionType>& _baseLearner;
+        /**
+         * Returns the seed, which the random streams of the models are derived from.
+         */
+        std::uint64_t resolveSeed() const {
+            return _seed >= 0 ? _seed : std::chrono::system_clock::now().time_since_epoch().count();
+        }
+
+        /**
+         * Draws the sample of a model, i.e. the seed of its learner and the row indices (with replacement).
+         *
+         * Every model draws its sample from its own counter-based random stream, which is derived from the seed and the model index. Hence, models can be fitted without
+         * any synchronization and the result does not depend on the number of workers.
+         *
+         * @param seed The seed of the ensemble (see `resolveSeed`).
+         * @param modelIndex The index of the model.
+         * @param nObservations The number of rows of the dataset.
+         * @param sampleIndices Receives `sampleSize` row indices.
+         * @return The seed of the learner.
+         */
+        int drawSample(std::uint64_t seed, unsigned int modelIndex, std::uint32_t nObservations, std::vector<unsigned int>& sampleIndices) const {
+            Philox generator(seed, modelIndex);
+            const int learnerSeed = static_cast<int>(generator() >> 1);
+            sampleIndices.resize(_sampleSize);
+            for (unsigned int j = 0; j < _sampleSize; j++)
+                sampleIndices[j] = generator.uniformInt(nObservations);
+            return learnerSeed;
+        }
+
+        /**
+         * Fits models using the random streams of the given model indices.
+         * @param dataset The dataset used to fit the models.
+         * @param firstModelIndex The index of the random stream of the first model.
+         * @param nModels The number of models to fit.
+         * @return The fitted models.
+         */
+        std::vector<ModelType> fitModels(const RowMatrixXRef<T>& dataset, unsigned int firstModelIndex, unsigned int nModels) const {
+            const std::uint64_t seed = _streamSeed;
+            const auto nObservations = static_cast<std::uint32_t>(dataset.rows());
+            return fitEachModel<ModelType>(
+                nModels,
+                [this, seed, firstModelIndex, nObservations](unsigned int i, std::vector<unsigned int>& sampleIndices) {
+                    return drawSample(seed, firstModelIndex + i, nObservations, sampleIndices);
+                },
+                [&dataset](Learner<ModelType, PredictionType, T>& learner, const std::vector<unsigned int>& sampleIndices) {
+                    learner.fit(dataset, sampleIndices);
+                    return learner.getModel();
+                });
+        }
+
+        /**
+         * Fits a prepared copy of the base learner for every model.
+         * @tparam ResultType The type of the result of a single call.
+         * @tparam SampleFunction A function, which is callable as `int(unsigned int modelIndex, std::vector<unsigned int>& sampleIndices)`. It provides the sample of a
+         * model and returns the seed of its learner.
+         * @tparam FitFunction See `fitSamples`.
+         * @param nModels The number of models to fit.
+         * @param sampleFunction The function, which provides the samples. It is called concurrently by multiple workers.
+         * @param fitFunction The function to call for every sample. It is called concurrently by multiple workers.
+         * @return The results of the calls in the order of the models.
+         */
+        template<typename ResultType, typename SampleFunction, typename FitFunction>
+        std::vector<ResultType> fitEachModel(unsigned int nModels, SampleFunction sampleFunction, FitFunction fitFunction) const {
+            // Either the models are fitted concurrently by a single team of workers, or, if there are fewer models than workers, one after another by all workers (see
+            // Tools::modelWorkerCount). In the latter case, the learner is not called from within a parallel region, such that it may split large nodes (in particular the
+            // root) with all workers. In both cases, the overall number of threads never exceeds the worker count.
+            const unsigned int teamWorkerCount = Tools::availableWorkerCount(_workerCount);
+            const unsigned int modelWorkerCount = Tools::modelWorkerCount(teamWorkerCount, nModels, _sampleSize);
+
+            // Estimate new models.
+            std::vector<ResultType> results(nModels);
+            auto fitModel = [&](unsigned int i) {
+                // Sample dataset with replacement. Only the row indices are drawn, the learner reads the rows from the dataset itself.
+                std::vector<unsigned int> sampleIndices;
+                const int learnerSeed = sampleFunction(i, sampleIndices);
+
+                // Take a copy of the base learner.
+                auto learnerCopy = _baseLearner.copy();
+                learnerCopy->setWorkerCount(modelWorkerCount);
+                learnerCopy->setSeed(learnerSeed);
+
+                // Fit base learner with sampled dataset and store the result at its index.
+                results[i] = fitFunction(*learnerCopy, sampleIndices);
+            };
+            if (modelWorkerCount > 1) {
+                for (unsigned int i = 0; i < nModels; i++)
+                    fitModel(i);
+            } else {
+#pragma omp parallel for schedule(dynamic) num_threads(teamWorkerCount)
+                for (unsigned int i = 0; i < nModels; i++)
+                    fitModel(i);
+            }
+
+            return results;
+        }
+
+        /**
+         * Draws the samples of all models as `fit` does and reads the sampled rows from a source with a known number of rows.
+         * @param reader The source of the rows.
+         * @param seed The seed of the ensemble (see `resolveSeed`).
+         * @param learnerSeeds Receives the seeds of the learners.
+         * @param samples Receives the samples of the models as indices into the returned rows.
+         * @return The distinct sampled rows (in the order of the source).
+         */
+        RowMatrixX<T> gatherSamples(RowReader<T>& reader, std::uint64_t seed, std::vector<int>& learnerSeeds, std::vector<std::vector<unsigned int>>& samples) const {
+            const std::uint64_t nObservations = reader.getNumberOfRows();
+            if (nObservations == 0 || nObservations > std::numeric_limits<std::uint32_t>::max())
+                throw std::runtime_error("BaggingEnsemble::fit: The number of rows of the source needs to be in [1, 2^32).");
+
+            std::vector<unsigned int> sampledRows;
+            for (unsigned int i = 0; i < _nModels; i++) {
+                learnerSeeds[i] = drawSample(seed, i, static_cast<std::uint32_t>(nObservations), samples[i]);
+                sampledRows.insert(sampledRows.end(), samples[i].begin(), samples[i].end());
+            }
+            std::sort(sampledRows.begin(), sampledRows.end());
+            sampledRows.erase(std::unique(sampledRows.begin(), sampledRows.end()), sampledRows.end());
+
+            // Read runs of consecutive sampled rows at once and skip the rows in between.
+            RowMatrixX<T> rows(sampledRows.size(), reader.getNumberOfColumns());
+            std::uint64_t position = 0;
+            for (size_t runBegin = 0, runEnd; runBegin < sampledRows.size(); runBegin = runEnd) {
+                for (runEnd = runBegin + 1; runEnd < sampledRows.size() && sampledRows[runEnd] == sampledRows[runEnd - 1] + 1; runEnd++)
+                    ;
+                reader.skip(sampledRows[runBegin] - position);
+                if (reader.read(rows.row(runBegin).data(), runEnd - runBegin) != runEnd - runBegin)
+                    throw std::runtime_error("BaggingEnsemble::fit: The source holds less rows than announced.");
+                position = sampledRows[runEnd - 1] + 1;
+            }
+
+            // Map the row indices of the samples to the gathered rows.
+            for (auto& sample : samples)
+                for (auto& index : sample)
+                    index = static_cast<unsigned int>(std::lower_bound(sampledRows.begin(), sampledRows.end(), index) - sampledRows.begin());
+            return rows;
+        }
+
+        /**
+         * Draws the samples of all models by reservoir sampling during a single pass over a source, whose number of rows is unknown.
+         *
+         * Every entry of every sample is a reservoir of size one, which holds a uniformly chosen row of the rows seen so far. After `t` rows, the next row, which replaces
+         * the entry, is drawn directly (at position `floor(t / U)` for U uniform in (0, 1]), hence the work per entry grows only logarithmically with the number of rows.
+         * Only the rows, which are held by any entry, are kept in memory.
+         *
+         * @param reader The source of the rows.
+         * @param seed The seed of the ensemble (see `resolveSeed`).
+         * @param learnerSeeds Receives the seeds of the learners.
+         * @param samples Receives the samples of the models as indices into the returned rows.
+         * @param nRows Receives the number of rows of the source.
+         * @return The distinct sampled rows.
+         */
+        RowMatrixX<T> reservoirSamples(RowReader<T>& reader, std::uint64_t seed, std::vector<int>& learnerSeeds, std::vector<std::vector<unsigned int>>& samples,
+                                       std::uint64_t& nRows) const {
+            const unsigned long nColumns = reader.getNumberOfColumns();
+            const std::uint64_t nEntries = static_cast<std::uint64_t>(_nModels) * _sampleSize;
+
+            // Every model draws from its own random stream. The learner seed is drawn first, like in `drawSample`.
+            std::vector<Philox> generators;
+            generators.reserve(_nModels);
+            for (unsigned int i = 0; i < _nModels; i++) {
+                generators.emplace_back(seed, i);
+                learnerSeeds[i] = static_cast<int>(generators[i]() >> 1);
+            }
+            auto nextReplacement = [&generators, this](std::uint64_t entry, std::uint64_t nSeen) {
+                const double u = std::ldexp(static_cast<double>((generators[entry / _sampleSize].next64() >> 11) + 1), -53);
+                const double next = std::floor(static_cast<double>(nSeen) / u);
+                return next < std::ldexp(1.0, 63) ? static_cast<std::uint64_t>(next) : std::numeric_limits<std::uint64_t>::max();
+            };
+
+            // The entries are ordered by the position of their next replacement (ties by entry index). Kept rows are reference counted and recycled.
+            typedef std::pair<std::uint64_t, std::uint64_t> Replacement;
+            std::priority_queue<Replacement, std::vector<Replacement>, std::greater<Replacement>> replacements;
+            for (std::uint64_t entry = 0; entry < nEntries; entry++)
+                replacements.emplace(0, entry);
+            std::vector<unsigned int> entryRows(nEntries);
+            std::vector<T> keptRows;
+            std::vector<std::uint64_t> references;
+            std::vector<unsigned int> freeRows;
+
+            const unsigned long chunkRows = 4096;
+            RowMatrixX<T> chunk(chunkRows, nColumns);
+            std::uint64_t position = 0;
+            for (unsigned long nRead; (nRead = reader.read(chunk.data(), chunkRows)) > 0; position += nRead) {
+                while (replacements.top().first < position + nRead) {
+                    // Keep the row and let all entries, which are due at its position, refer to it.
+                    const std::uint64_t rowPosition = replacements.top().first;
+                    unsigned int keptRow;
+                    if (freeRows.empty()) {
+                        keptRow = static_cast<unsigned int>(references.size());
+                        references.push_back(0);
+                        keptRows.resize(keptRows.size() + nColumns);
+                    } else {
+                        keptRow = freeRows.back();
+                        freeRows.pop_back();
+                    }
+                    std::copy_n(chunk.row(rowPosition - position).data(), nColumns, keptRows.begin() + keptRow * nColumns);
+
+                    while (replacements.top().first == rowPosition) {
+                        const std::uint64_t entry = replacements.top().second;
+                        replacements.pop();
+                        if (rowPosition > 0 && --references[entryRows[entry]] == 0)
+                            freeRows.push_back(entryRows[entry]);
+                        entryRows[entry] = keptRow;
+                        references[keptRow]++;
+                        replacements.emplace(nextReplacement(entry, rowPosition + 1), entry);
+                    }
+                }
+            }
+            if (position == 0)
+                throw std::runtime_error("BaggingEnsemble::fit: The source does not hold any rows.");
+            nRows = position;
+
+            // Compact the kept rows, which are still referenced.
+            std::vector<unsigned int> rowIndices(references.size());
+            unsigned int nKept = 0;
+            for (size_t r = 0; r < references.size(); r++)
+                rowIndices[r] = references[r] > 0 ? nKept++ : 0;
+            RowMatrixX<T> rows(nKept, nColumns);
+            for (size_t r = 0; r < references.size(); r++)
+                if (references[r] > 0)
+                    rows.row(rowIndices[r]) = Eigen::Map<const Eigen::Matrix<T, 1, Eigen::Dynamic>>(keptRows.data() + r * nColumns, nColumns);
+            for (unsigned int i = 0; i < _nModels; i++) {
+                samples[i].resize(_sampleSize);
+                for (unsigned int j = 0; j < _sampleSize; j++)
+                    samples[i][j] = rowIndices[entryRows[static_cast<std::uint64_t>(i) * _sampleSize + j]];
+            }
+            return rows;
+        }
+
+        const Learner<ModelType, PredictionType, T>& _baseLearner;
         unsigned int _nModels;
         unsigned int _sampleSize;
         unsigned int _workerCount;
         int _seed;
+        std::uint64_t _streamSeed; // The seed of the random streams of the current models (see `resolveSeed`).
+        unsigned int _nextModelIndex = 0; // The index of the random stream of the next added model.
+        std::uint64_t _nObservations = 0; // The number of observations of the dataset, which the latest models have been fitted on.
 
         std::vector<ModelType> _models;
     };
@@ -2,12 +2,17 @@
 #define GENIF_LEARNER_H
 
 #include <genif/io/DataTypeHandling.h>
+#include <vector>
 
 namespace genif {
     /**
      * Provides a standardized interface for learning algorithms.
+     *
+     * @tparam ModelType The type of model, that the learner yields as result from calling `fit`.
+     * @tparam PredictionType The type of prediction, that the learner yields as result from calling either `fitPredict` and `predict`.
+     * @tparam T The scalar type of the datasets (float or double).
      */
-    template<typename ModelType, typename PredictionType>
+    template<typename ModelType, typename PredictionType, typename T>
     class Learner {
     public:
         /**
@@ -17,10 +22,25 @@ namespace genif {
          * @param dataset The dataset, which should be used for fitting.
          * @return A reference to the learner.
          */
-        virtual Learner<ModelType, PredictionType>& fit(const MatrixX& dataset) {
+        virtual Learner<ModelType, PredictionType, T>& fit(const RowMatrixXRef<T>& dataset) {
             throw std::runtime_error("Learner::fit: Not implemented.");
         };
 
+        /**
+         * Fits the learner using a subset of the rows of a given dataset. Classes implementing this method should read the selected rows from the dataset without copying
+         * them. The default implementation copies the selected rows into a new matrix and calls fit() with it.
+         *
+         * @param dataset The dataset, which holds the observations.
+         * @param rowIndices The indices of the rows, which should be used for fitting (rows may occur multiple times).
+         * @return A reference to the learner.
+         */
+        virtual Learner<ModelType, PredictionType, T>& fit(const RowMatrixXRef<T>& dataset, const std::vector<unsigned int>& rowIndices) {
+            RowMatrixX<T> selectedDataset(rowIndices.size(), dataset.cols());
+            for (unsigned int i = 0; i < rowIndices.size(); i++)
+                selectedDataset.row(i) = dataset.row(rowIndices[i]);
+            return fit(selectedDataset);
+        }
+
         /**
          * Fits the learner using a given dataset and returns predictions based on it. Classes implementing this
          * method should assign the learned model to themselves, which can then be retrieved using the getModel() method.
@@ -30,7 +50,7 @@ namespace genif {
          * @param dataset The dataset, which should be used for fitting and predicting.
          * @return Predictions, which were made by using the dataset. The actual type of prediction, which is made, is determined by the PredictionType template parameter.
          */
-        virtual PredictionType fitPredict(const MatrixX& dataset) {
+        virtual PredictionType fitPredict(const RowMatrixXRef<T>& dataset) {
             return fit(dataset).predict(dataset);
         };
 
@@ -42,7 +62,7 @@ namespace genif {
          * @param dataset The dataset, which should be used for predicting.
          * @return Predictions, which were made by using the dataset. The actual type of prediction, which is made, is determined by the PredictionType template parameter.
          */
-        virtual PredictionType predict(const MatrixX& dataset) const {
+        virtual PredictionType predict(const RowMatrixXRef<T>& dataset) const {
             throw std::runtime_error("Learner::predict: Not implemented.");
         };
 
@@ -55,7 +75,7 @@ namespace genif {
          * @param model The fitted model.
          * @return Predictions, which were made by using the dataset. The actual type of prediction, which is made, is determined by the PredictionType template parameter.
          */
-        virtual PredictionType predict(const MatrixX& dataset, const ModelType& model) const {
+        virtual PredictionType predict(const RowMatrixXRef<T>& dataset, const ModelType& model) const {
             throw std::runtime_error("Learner::predict: Not implemented.");
         };
 
@@ -68,11 +88,25 @@ namespace genif {
             throw std::runtime_error("Learner::getModel: Not implemented.");
         };
 
+        /**
+         * Sets the number of workers, which the learner may use. Learners, which do not parallelize their work, may ignore this.
+         * @param workerCount The number of workers.
+         */
+        virtual void setWorkerCount(unsigned int workerCount) {
+        }
+
+        /**
+         * Sets the seed, which the learner uses for random number generation. Deterministic learners may ignore this.
+         * @param seed Seed to use for random number generation (-1 defaults to sysclock seed).
+         */
+        virtual void setSeed(int seed) {
+        }
+
         /**
          * Takes a copy of the learner and returns it.
          * @return Non-const copy of the learner.
          */
-        virtual std::unique_ptr<Learner<ModelType, PredictionType>> copy() const {
+        virtual std::unique_ptr<Learner<ModelType, PredictionType, T>> copy() const {
             throw std::runtime_error("Learner::copy: Not implemented.");
         }
 
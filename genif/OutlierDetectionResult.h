@@ -6,16 +6,18 @@
 namespace genif {
     /**
      * A struct holding a outlier detection result.
+     * @tparam T The scalar type of the probabilities (float or double).
      */
+    template<typename T>
     struct OutlierDetectionResult {
-        VectorX probabilities;
+        VectorX<T> probabilities;
 
         /**
          * Returns a const-reference to the probability vector stored in this object. The particular notion of probability is determined by the algorithm used. GIF will usually
          * report higher probabilities to be indicating inlierness.
          * @return As stated above.
          */
-        const VectorX& getProbabilities() const {
+        const VectorX<T>& getProbabilities() const {
             return probabilities;
         }
     };
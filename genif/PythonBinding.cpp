@@ -7,16 +7,152 @@
 namespace py = pybind11;
 
 namespace genif {
+    /**
+     * Reads the rows of a Python iterator, which yields two-dimensional arrays (chunks) of arbitrary numbers of rows. The GIL is acquired for every access to the iterator,
+     * since rows are read by another thread while the current chunk is scored.
+     * @tparam T The scalar type of the rows (float or double).
+     */
+    template<typename T>
+    class IteratorRowReader : public RowReader<T> {
+    public:
+        /**
+         * Creates a reader. The first chunk is fetched immediately in order to determine the number of columns.
+         * @param iterator The iterator over the chunks.
+         */
+        explicit IteratorRowReader(py::iterator iterator) : _iterator(std::move(iterator)) {
+            nextChunk();
+        }
+
+        unsigned long getNumberOfColumns() const override {
+            return _chunk.cols();
+        }
+
+        unsigned long read(T* rows, unsigned long maxRows) override {
+            py::gil_scoped_acquire acquire;
+            unsigned long nRows = 0;
+            while (nRows < maxRows && (_position < _chunk.rows() || nextChunk())) {
+                const long n = std::min<long>(maxRows - nRows, _chunk.rows() - _position);
+                Eigen::Map<RowMatrixX<T>>(rows + nRows * _chunk.cols(), n, _chunk.cols()) = _chunk.middleRows(_position, n);
+                _position += n;
+                nRows += n;
+            }
+            return nRows;
+        }
+
+    private:
+        py::iterator _iterator;
+        RowMatrixX<T> _chunk;
+        long _position = 0;
+
+        /**
+         * Fetches the next non-empty chunk from the iterator.
+         * @return False, if the iterator is exhausted.
+         */
+        bool nextChunk() {
+            for (; _iterator != py::iterator::sentinel(); ++_iterator) {
+                auto chunk = _iterator->template cast<RowMatrixX<T>>();
+                if (_chunk.cols() > 0 && chunk.cols() != _chunk.cols())
+                    throw std::runtime_error("IteratorRowReader::nextChunk: All chunks need to have the same number of columns.");
+                _chunk = std::move(chunk);
+                _position = 0;
+                if (_chunk.rows() > 0) {
+                    ++_iterator;
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    /**
+     * Binds GeneralizedIsolationForest for a given scalar type.
+     * @tparam T The scalar type (float or double). Data matrices are expected to hold this type, other types are converted by NumPy.
+     * @param m The module to bind the class to.
+     * @param modelName The Python name of the (opaque) model class of a single tree.
+     * @param learnerName The Python name of the learner base class.
+     * @param forestName The Python name of the forest class.
+     */
+    template<typename T>
+    void bindGeneralizedIsolationForest(py::module& m, const char* modelName, const char* learnerName, const char* forestName) {
+        // Data matrices are bound to RowMatrixXRef, hence C-contiguous arrays of the scalar type are passed through without copying them.
+        using GIFModel_VecX_Learner = Learner<std::vector<GIFModel<T>>, VectorX<T>, T>;
+        py::class_<GIFModel<T>>(m, modelName);
+        py::class_<GIFModel_VecX_Learner>(m, learnerName);
+        py::class_<GeneralizedIsolationForest<T>, GIFModel_VecX_Learner>(m, forestName)
+            .def(py::init<unsigned int, unsigned int, unsigned int, std::string, VectorX<T>&, T, int, int, T>(), py::arg("k"), py::arg("n_models"), py::arg("sample_size"),
+                 py::arg("kernel"), py::arg("kernel_scaling"), py::arg("sigma"), py::arg("worker_count") = -1, py::arg("seed") = -1, py::arg("approximation_delta") = 0.0)
+            .def("fit", py::overload_cast<const RowMatrixXRef<T>&>(&GeneralizedIsolationForest<T>::fit), py::arg("X"))
+            .def(
+                "fit_file",
+                [](GeneralizedIsolationForest<T>& forest, const std::string& path, unsigned long nColumns, std::uint64_t offset) -> GIFModel_VecX_Learner& {
+                    BinaryFileRowReader<T> reader(path, nColumns, offset);
+                    return forest.fit(reader);
+                },
+                py::arg("path"), py::arg("n_columns"), py::arg("offset") = 0)
+            .def(
+                "fit_stream",
+                [](GeneralizedIsolationForest<T>& forest, py::iterator chunks) -> GIFModel_VecX_Learner& {
+                    IteratorRowReader<T> reader(std::move(chunks));
+                    return forest.fit(reader);
+                },
+                py::arg("chunks"))
+            .def("fit_sigmas", &GeneralizedIsolationForest<T>::fitSigmas, py::arg("X"), py::arg("sigmas"))
+            .def("predict", py::overload_cast<const RowMatrixXRef<T>&>(&GeneralizedIsolationForest<T>::predict, py::const_), py::arg("X"))
+            .def("predict", py::overload_cast<const RowMatrixXRef<T>&, const std::vector<GIFModel<T>>&>(&GeneralizedIsolationForest<T>::predict, py::const_), py::arg("X"),
+                 py::arg("models"))
+            .def(
+                "predict_stream",
+                [](const GeneralizedIsolationForest<T>& forest, const RowMatrixXRef<T>& X, VectorXRef<T> out, unsigned long chunkRows) {
+                    MatrixRowReader<T> reader(X);
+                    py::gil_scoped_release release;
+                    return forest.predict(reader, out, chunkRows);
+                },
+                py::arg("X"), py::arg("out").noconvert(), py::arg("chunk_rows") = 65536)
+            .def(
+                "predict_stream",
+                [](const GeneralizedIsolationForest<T>& forest, py::iterator chunks, VectorXRef<T> out, unsigned long chunkRows) {
+                    IteratorRowReader<T> reader(std::move(chunks));
+                    py::gil_scoped_release release;
+                    return forest.predict(reader, out, chunkRows);
+                },
+                py::arg("chunks"), py::arg("out").noconvert(), py::arg("chunk_rows") = 65536)
+            .def(
+                "predict_file",
+                [](const GeneralizedIsolationForest<T>& forest, const std::string& path, unsigned long nColumns, VectorXRef<T> out, unsigned long chunkRows,
+                   std::uint64_t offset) {
+                    py::gil_scoped_release release;
+                    BinaryFileRowReader<T> reader(path, nColumns, offset);
+                    return forest.predict(reader, out, chunkRows);
+                },
+                py::arg("path"), py::arg("n_columns"), py::arg("out").noconvert(), py::arg("chunk_rows") = 65536, py::arg("offset") = 0)
+            .def("add_models", &GeneralizedIsolationForest<T>::addModels, py::arg("X"), py::arg("n_models"))
+            .def("replace_models", &GeneralizedIsolationForest<T>::replaceModels, py::arg("X"), py::arg("indices"))
+            .def("update", &GeneralizedIsolationForest<T>::update, py::arg("X"), py::arg("decay") = 1.0, py::arg("window_size") = 0)
+            .def("fit_predict", &GeneralizedIsolationForest<T>::fitPredict, py::arg("X"))
+            .def_property_readonly("models", &GeneralizedIsolationForest<T>::getModel)
+            .def_property(
+                "worker_count", &GeneralizedIsolationForest<T>::getWorkerCount,
+                [](GeneralizedIsolationForest<T>& forest, int workerCount) { forest.setWorkerCount(Tools::handleWorkerCount(workerCount)); })
+            .def("save", &GeneralizedIsolationForest<T>::save, py::arg("path"))
+            .def_static("load", &GeneralizedIsolationForest<T>::load, py::arg("path"), py::arg("worker_count") = -1)
+            .def_static("merge", &GeneralizedIsolationForest<T>::merge, py::arg("forests"))
+            .def(py::pickle(
+                [](const GeneralizedIsolationForest<T>& forest) {
+                    const std::vector<unsigned char> state = forest.serialize();
+                    return py::bytes(reinterpret_cast<const char*>(state.data()), state.size());
+                },
+                [](const py::bytes& state) {
+                    char* data;
+                    Py_ssize_t size;
+                    if (PyBytes_AsStringAndSize(state.ptr(), &data, &size) != 0)
+                        throw py::error_already_set();
+                    return GeneralizedIsolationForest<T>::deserialize(reinterpret_cast<const unsigned char*>(data), static_cast<std::uint64_t>(size));
+                }));
+    }
+
     PYBIND11_MODULE(genif, m) {
-        // Definition: Generalized Isolation Forest
-        using GIFModel_VecX_Learner = Learner<std::vector<GIFModel>, VectorX>;
-        py::class_<GIFModel_VecX_Learner>(m, "GIFModel_ODR_Learner");
-        py::class_<GeneralizedIsolationForest, GIFModel_VecX_Learner>(m, "GeneralizedIsolationForest")
-            .def(py::init<unsigned int, unsigned int, unsigned int, std::string, VectorX&, data_t, int, int>(), py::arg("k"), py::arg("n_models"), py::arg("sample_size"),
-                 py::arg("kernel"), py::arg("kernel_scaling"), py::arg("sigma"), py::arg("worker_count") = -1, py::arg("seed") = -1)
-            .def("fit", &GeneralizedIsolationForest::fit, py::arg("X"))
-            .def("predict", &GeneralizedIsolationForest::predict, py::arg("X"))
-            .def("fit_predict", &GeneralizedIsolationForest::fitPredict, py::arg("X"))
-            .def_property_readonly("models", &GeneralizedIsolationForest::getModel);
+        // Definition: Generalized Isolation Forest (double and single precision)
+        bindGeneralizedIsolationForest<double>(m, "GIFModel", "GIFModel_ODR_Learner", "GeneralizedIsolationForest");
+        bindGeneralizedIsolationForest<float>(m, "GIFModel32", "GIFModel_ODR_Learner32", "GeneralizedIsolationForest32");
     }
-}
\ No newline at end of file
+}
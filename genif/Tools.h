@@ -10,6 +10,10 @@
 #include <thread>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace genif {
         /**
          * Provide different handy tools to accomplish general tasks in this framework.
@@ -29,6 +33,46 @@ namespace genif {
                     return workerCount;
             }
 
+            /**
+             * Returns, whether the calling thread currently executes within an active OpenMP parallel region. Code running there should not open nested parallel regions,
+             * but rather spawn tasks into the enclosing team, such that the overall number of threads stays within the worker count.
+             * @return As stated above.
+             */
+            static bool isInParallelRegion() {
+#ifdef _OPENMP
+                return omp_in_parallel() != 0;
+#else
+                return false;
+#endif
+            }
+
+            /**
+             * Returns the number of workers, which a parallel region opened by the caller may use. Within an active parallel region, this is always one, since the workers of the
+             * enclosing team are already busy.
+             * @param workerCount The worker count of the caller.
+             * @return As stated above.
+             */
+            static unsigned int availableWorkerCount(unsigned int workerCount) {
+                return isInParallelRegion() ? 1 : workerCount;
+            }
+
+            /**
+             * Decides, how many workers each model may use, if `nModels` models are fitted with a budget of `workerCount` workers. If there are at least as many models as
+             * workers or if the samples are too small to be split any further, every model is fitted by a single worker and the models are fitted concurrently. Otherwise,
+             * the models are fitted one after another and every model may use all workers (see BaggingEnsemble::fitEachModel).
+             * @param workerCount The overall worker budget.
+             * @param nModels The number of models to fit.
+             * @param sampleSize The number of observations, which are used to fit each model.
+             * @return As stated above.
+             */
+            static unsigned int modelWorkerCount(unsigned int workerCount, unsigned int nModels, unsigned int sampleSize) {
+                const unsigned int minParallelSampleSize = 2048;
+                if (nModels >= workerCount || sampleSize < minParallelSampleSize)
+                    return 1;
+                else
+                    return workerCount;
+            }
+
         private:
             /**
              * Returns the number of available processing cores by evaluating `std::thread::hardware_concurrency()`. If the function call fails, one is returned.
@@ -0,0 +1,619 @@
+#ifndef GENIF_COMPILEDFOREST_H
+#define GENIF_COMPILEDFOREST_H
+
+#include "GIFModel.h"
+#include "LeafIndex.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <genif/Tools.h>
+#include <genif/io/DataTypeHandling.h>
+#include <genif/io/RowReader.h>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace genif {
+    /**
+     * Describes the position of a single tree within the buffer of a CompiledForest. All offsets are byte offsets from the beginning of the buffer.
+     */
+    struct CompiledTreeLayout {
+        std::uint64_t nLeaves; // The number of leaves (i.e. regions) of the tree.
+        std::uint64_t nNodes; // The number of nodes of the search tree over the leaves (zero for brute force search).
+        std::uint64_t searchMethod; // The LeafSearchMethod, which is used to find the nearest leaf.
+        double treeWeight; // The weight of the tree in the average over all trees (see GIFModel::treeWeight).
+        std::uint64_t leafOffset; // Leaf vectors (nLeaves x stride scalar values, row-major, in search order).
+        std::uint64_t probabilityOffset; // Region probabilities (nLeaves scalar values, in search order).
+        std::uint64_t countOffset; // Numbers of observations per region (nLeaves uint64 values, in search order).
+        std::uint64_t weightOffset; // Weights of the regions, which the probabilities are derived from (nLeaves scalar values, in search order).
+        std::uint64_t regionOffset; // Region indices of the model, which the leaves stem from (nLeaves uint32 values, in search order).
+        std::uint64_t splitValueOffset; // Split values of the search tree nodes (nNodes scalar values).
+        std::uint64_t splitDimensionOffset; // Split dimensions of the search tree nodes (nNodes int32 values, -1 for buckets).
+        std::uint64_t firstOffset; // Left children of inner nodes or first leaves of buckets (nNodes uint32 values).
+        std::uint64_t secondOffset; // Right children of inner nodes or one past the last leaves of buckets (nNodes uint32 values).
+    };
+
+    /**
+     * Describes the buffer of a CompiledForest. The header is followed by one CompiledTreeLayout per tree and the data sections of all trees.
+     *
+     * The buffer does not contain any pointers, hence it may be written to a file as is and used again after loading or memory-mapping it (see CompiledForest::fromBuffer).
+     * All values are stored in the byte order of the host, which is detected by the magic number.
+     */
+    struct CompiledForestHeader {
+        std::uint64_t magic; // The ASCII characters "GIFCFRST" (see CompiledForest::magic).
+        std::uint64_t version; // The version of the buffer format (see CompiledForest::formatVersion).
+        std::uint64_t size; // The overall size of the buffer in bytes.
+        std::uint64_t scalarSize; // The size of the scalar type in bytes (4 for float, 8 for double).
+        std::uint64_t nTrees; // The number of trees.
+        std::uint64_t nDimensions; // The number of dimensions of the leaf vectors.
+        std::uint64_t stride; // The number of scalar values between two consecutive leaf vectors.
+        std::uint64_t treeTableOffset; // The byte offset of the first CompiledTreeLayout.
+    };
+
+    /**
+     * An inference-only representation of a forest of GIFModels.
+     *
+     * Compiling packs the leaf vectors, region probabilities and the search structure (see LeafIndex) of every model into a single contiguous, aligned buffer in
+     * structure-of-arrays layout. Prediction only reads from this buffer, which keeps the working set compact when scoring against many trees. Apart from the region
+     * weights and probabilities (see `updateWeights`), the buffer is never modified.
+     *
+     * @tparam T The scalar type of the leaf vectors and probabilities (float or double).
+     */
+    template<typename T>
+    class CompiledForest {
+    public:
+        static const std::uint64_t magic = 0x5453524643464947; // The ASCII characters "GIFCFRST" in little-endian byte order.
+        static const std::uint64_t formatVersion = 4; // The version of the buffer format, which needs to be increased with every change of the layout.
+
+        /**
+         * Constructs an empty CompiledForest.
+         */
+        CompiledForest() = default;
+
+        /**
+         * Compiles a list of models.
+         * @param models The models to compile. All models need to share the same number of dimensions.
+         */
+        explicit CompiledForest(const std::vector<GIFModel<T>>& models) {
+            if (models.empty())
+                return;
+
+            // Determine the layout of the buffer.
+            const auto nDimensions = static_cast<std::uint64_t>(models[0].dataMatrix->cols());
+            const std::uint64_t stride = LeafIndex<T>::paddedStride(nDimensions);
+            std::vector<std::shared_ptr<const LeafIndex<T>>> leafIndices(models.size());
+            std::vector<CompiledTreeLayout> layouts(models.size());
+
+            std::uint64_t size = align(sizeof(CompiledForestHeader));
+            const std::uint64_t treeTableOffset = size;
+            size = align(size + models.size() * sizeof(CompiledTreeLayout));
+            for (unsigned int t = 0; t < models.size(); t++) {
+                if (static_cast<std::uint64_t>(models[t].dataMatrix->cols()) != nDimensions)
+                    throw std::runtime_error("CompiledForest::CompiledForest: All models need to have the same number of dimensions.");
+
+                // Reuse the search structure of the model, which also determines the order of the leaves.
+                if (models[t].leafIndex)
+                    leafIndices[t] = models[t].leafIndex;
+                else
+                    leafIndices[t] = std::make_shared<LeafIndex<T>>(*models[t].dataMatrix);
+
+                auto& layout = layouts[t];
+                layout.nLeaves = leafIndices[t]->getNumberOfLeaves();
+                layout.nNodes = leafIndices[t]->getNumberOfNodes();
+                layout.searchMethod = static_cast<std::uint64_t>(leafIndices[t]->getMethod());
+                layout.treeWeight = models[t].treeWeight;
+                layout.leafOffset = size;
+                size = align(size + layout.nLeaves * stride * sizeof(T));
+                layout.probabilityOffset = size;
+                size = align(size + layout.nLeaves * sizeof(T));
+                layout.countOffset = size;
+                size = align(size + layout.nLeaves * sizeof(std::uint64_t));
+                layout.weightOffset = size;
+                size = align(size + layout.nLeaves * sizeof(T));
+                layout.regionOffset = size;
+                size = align(size + layout.nLeaves * sizeof(std::uint32_t));
+                layout.splitValueOffset = size;
+                size = align(size + layout.nNodes * sizeof(T));
+                layout.splitDimensionOffset = size;
+                size = align(size + layout.nNodes * sizeof(std::int32_t));
+                layout.firstOffset = size;
+                size = align(size + layout.nNodes * sizeof(std::uint32_t));
+                layout.secondOffset = size;
+                size = align(size + layout.nNodes * sizeof(std::uint32_t));
+            }
+
+            // Allocate the buffer and fill it.
+            auto buffer = std::make_shared<Buffer>(size, 0);
+            unsigned char* data = buffer->data();
+            CompiledForestHeader header = {magic, formatVersion, size, sizeof(T), models.size(), nDimensions, stride, treeTableOffset};
+            std::memcpy(data, &header, sizeof(header));
+            std::memcpy(data + treeTableOffset, layouts.data(), layouts.size() * sizeof(CompiledTreeLayout));
+            for (unsigned int t = 0; t < models.size(); t++) {
+                const auto& layout = layouts[t];
+                const LeafSearch<T> search = leafIndices[t]->getSearch();
+                auto* probabilities = reinterpret_cast<T*>(data + layout.probabilityOffset);
+                auto* counts = reinterpret_cast<std::uint64_t*>(data + layout.countOffset);
+                auto* weights = reinterpret_cast<T*>(data + layout.weightOffset);
+                for (unsigned int i = 0; i < layout.nLeaves; i++) {
+                    const std::uint32_t region = search.regions[i];
+                    probabilities[i] = models[t].probabilitiesPerRegion[region];
+                    counts[i] = models[t].countsPerRegion.empty() ? 0 : models[t].countsPerRegion[region];
+                    weights[i] = models[t].weightsPerRegion.empty() ? static_cast<T>(counts[i]) : models[t].weightsPerRegion[region];
+                }
+                std::memcpy(data + layout.leafOffset, search.leafValues, layout.nLeaves * stride * sizeof(T));
+                std::memcpy(data + layout.regionOffset, search.regions, layout.nLeaves * sizeof(std::uint32_t));
+                if (layout.nNodes > 0) {
+                    std::memcpy(data + layout.splitValueOffset, search.splitValues, layout.nNodes * sizeof(T));
+                    std::memcpy(data + layout.splitDimensionOffset, search.splitDimensions, layout.nNodes * sizeof(std::int32_t));
+                    std::memcpy(data + layout.firstOffset, search.first, layout.nNodes * sizeof(std::uint32_t));
+                    std::memcpy(data + layout.secondOffset, search.second, layout.nNodes * sizeof(std::uint32_t));
+                }
+            }
+
+            _owner = buffer;
+            _data = data;
+            _writable = true;
+        }
+
+        /**
+         * Creates a CompiledForest from a buffer, which has been obtained from `data()` before (e.g. by reading or memory-mapping a file). The buffer is validated, but not
+         * rebuilt.
+         * @param data Pointer to the buffer.
+         * @param size The number of available bytes at `data`.
+         * @param owner An object, which keeps the buffer alive. The buffer is used in place, if an owner is given and the buffer is aligned to 8 bytes, otherwise it is copied.
+         * @return As stated above.
+         */
+        static CompiledForest fromBuffer(const unsigned char* data, std::uint64_t size, std::shared_ptr<const void> owner = nullptr) {
+            if (size < sizeof(CompiledForestHeader))
+                throw std::runtime_error("CompiledForest::fromBuffer: The buffer is too small.");
+
+            CompiledForest forest;
+            if (owner && reinterpret_cast<std::uintptr_t>(data) % sizeof(std::uint64_t) == 0) {
+                forest._owner = std::move(owner);
+                forest._data = data;
+            } else {
+                auto buffer = std::make_shared<Buffer>(data, data + size);
+                forest._owner = buffer;
+                forest._data = buffer->data();
+                forest._writable = true;
+            }
+            forest.validate(size);
+            return forest;
+        }
+
+        /**
+         * Returns a pointer to the buffer, which holds the whole forest. The buffer may be stored and passed to `fromBuffer` later on.
+         * @return As stated above (`nullptr` for empty forests).
+         */
+        const unsigned char* data() const {
+            return _data;
+        }
+
+        /**
+         * Returns the size of the buffer in bytes.
+         * @return As stated above.
+         */
+        std::uint64_t size() const {
+            return _data == nullptr ? 0 : header().size;
+        }
+
+        /**
+         * Recovers the models, which this forest has been compiled from. The search structures are copied from the buffer and not rebuilt.
+         * @return As stated above.
+         */
+        std::vector<GIFModel<T>> getModels() const {
+            std::vector<GIFModel<T>> models(getNumberOfTrees());
+            for (unsigned long t = 0; t < models.size(); t++) {
+                const auto& layout = treeLayout(t);
+                const LeafSearch<T> search = treeSearch(layout);
+                const auto* probabilities = reinterpret_cast<const T*>(_data + layout.probabilityOffset);
+                const auto* counts = reinterpret_cast<const std::uint64_t*>(_data + layout.countOffset);
+                const auto* weights = reinterpret_cast<const T*>(_data + layout.weightOffset);
+
+                auto& model = models[t];
+                model.treeWeight = layout.treeWeight;
+                model.dataMatrix = std::make_shared<MatrixX<T>>(layout.nLeaves, header().nDimensions);
+                model.probabilitiesPerRegion.resize(layout.nLeaves);
+                model.countsPerRegion.resize(layout.nLeaves);
+                model.weightsPerRegion.resize(layout.nLeaves);
+                for (std::uint64_t i = 0; i < layout.nLeaves; i++) {
+                    const std::uint32_t region = search.regions[i];
+                    model.dataMatrix->row(region) = Eigen::Map<const Eigen::Matrix<T, 1, Eigen::Dynamic>>(search.leafValues + i * search.stride, search.nDimensions);
+                    model.probabilitiesPerRegion[region] = probabilities[i];
+                    model.countsPerRegion[region] = counts[i];
+                    model.weightsPerRegion[region] = weights[i];
+                }
+                model.leafIndex = std::make_shared<LeafIndex<T>>(search, layout.nNodes);
+            }
+            return models;
+        }
+
+        /**
+         * Returns, whether the forest holds no trees.
+         * @return As stated above.
+         */
+        bool empty() const {
+            return _data == nullptr || header().nTrees == 0;
+        }
+
+        /**
+         * Returns the number of trees in this forest.
+         * @return As stated above.
+         */
+        unsigned long getNumberOfTrees() const {
+            return _data == nullptr ? 0 : header().nTrees;
+        }
+
+        /**
+         * Returns the number of dimensions of the vectors, which this forest can score.
+         * @return As stated above.
+         */
+        unsigned long getNumberOfDimensions() const {
+            return _data == nullptr ? 0 : header().nDimensions;
+        }
+
+        /**
+         * Finds the region of a tree, which a vector falls into, i.e. the index of the nearest leaf vector. Ties are resolved in favor of the lowest region index.
+         * @param tree The index of the tree.
+         * @param vector Pointer to the vector (`getNumberOfDimensions()` contiguous entries).
+         * @return The index of the region w.r.t. the GIFModel, which the tree has been compiled from.
+         */
+        size_t findRegion(unsigned long tree, const T* vector) const {
+            const auto& layout = treeLayout(tree);
+            return reinterpret_cast<const std::uint32_t*>(_data + layout.regionOffset)[treeSearch(layout).findLeaf(vector)];
+        }
+
+        /**
+         * Predicts the probability of inlierness for every row of a dataset by averaging over all trees. The trees of merged forests are weighted (see
+         * GIFModel::treeWeight), all other trees count alike.
+         *
+         * The dataset is processed in blocks of rows. Every block is scored against all trees, while it is still cached, and every tree answers the queries of a whole block
+         * at once.
+         *
+         * @param dataset The dataset to inspect.
+         * @param workerCount Number of workers to consider.
+         * @return A vector, which indicates the probability of inlierness for every input vector.
+         */
+        VectorX<T> predict(const RowMatrixXRef<T>& dataset, unsigned int workerCount) const {
+            VectorX<T> y(dataset.rows());
+            predict(dataset, y.data(), workerCount);
+            return y;
+        }
+
+        /**
+         * Predicts the probability of inlierness for all rows of a source, which is consumed chunk by chunk. While a chunk is scored, the next chunk is read by another
+         * thread. Apart from the output, the memory consumption is bounded by two chunks.
+         * @param reader The source of the rows.
+         * @param output Receives the probability of inlierness for every row. It needs to provide an entry for every row of the source.
+         * @param chunkRows The number of rows per chunk.
+         * @param workerCount Number of workers to consider.
+         * @return The number of rows, which have been scored.
+         */
+        std::uint64_t predict(RowReader<T>& reader, VectorXRef<T> output, unsigned long chunkRows, unsigned int workerCount) const {
+            if (empty())
+                throw std::runtime_error("CompiledForest::predict: The forest does not hold any trees.");
+            if (reader.getNumberOfColumns() != getNumberOfDimensions())
+                throw std::runtime_error("CompiledForest::predict: The rows need to have " + std::to_string(getNumberOfDimensions()) + " columns.");
+            if (chunkRows == 0)
+                throw std::runtime_error("CompiledForest::predict: The number of rows per chunk needs to be positive.");
+
+            std::array<RowMatrixX<T>, 2> chunks = {RowMatrixX<T>(chunkRows, reader.getNumberOfColumns()), RowMatrixX<T>(chunkRows, reader.getNumberOfColumns())};
+            VectorX<T> scores(chunkRows);
+            auto readChunk = [&reader, chunkRows](RowMatrixX<T>* chunk) { return reader.read(chunk->data(), chunkRows); };
+
+            std::uint64_t nScored = 0;
+            unsigned long nRows = readChunk(&chunks[0]);
+            for (unsigned int current = 0; nRows > 0; current = 1 - current) {
+                if (nScored + nRows > static_cast<std::uint64_t>(output.size()))
+                    throw std::runtime_error("CompiledForest::predict: The output provides " + std::to_string(output.size()) + " entries, but the source holds more rows.");
+                std::future<unsigned long> nextRows = std::async(std::launch::async, readChunk, &chunks[1 - current]);
+                predict(chunks[current].topRows(nRows), scores.data(), workerCount);
+                output.segment(nScored, nRows) = scores.head(nRows);
+                nScored += nRows;
+                nRows = nextRows.get();
+            }
+            return nScored;
+        }
+
+        /**
+         * Counts the rows of a dataset, which fall into each leaf of every tree.
+         * @param dataset The dataset to inspect.
+         * @param workerCount Number of workers to consider.
+         * @return The counts of all trees one after another, each in the order of the leaves in the buffer (see `getWeights`).
+         */
+        std::vector<T> countLeaves(const RowMatrixXRef<T>& dataset, unsigned int workerCount) const {
+            if (static_cast<unsigned long>(dataset.cols()) != getNumberOfDimensions())
+                throw std::runtime_error("CompiledForest::countLeaves: The dataset needs to have " + std::to_string(getNumberOfDimensions()) + " columns.");
+
+            const std::vector<std::uint64_t> leafBegins = leafBeginnings();
+            const long blockSize = 256;
+            std::vector<T> counts(leafBegins.back(), 0);
+
+            // Every tree is processed by a single worker, hence the counts of a tree are never updated concurrently.
+#pragma omp parallel num_threads(Tools::availableWorkerCount(workerCount))
+            {
+                RowMatrixX<T> blockRows;
+                std::vector<unsigned int> leaves(blockSize);
+                std::vector<T> sqDistances(blockSize);
+
+#pragma omp for schedule(dynamic)
+                for (long t = 0; t < static_cast<long>(getNumberOfTrees()); t++) {
+                    const LeafSearch<T> search = treeSearch(treeLayout(t));
+                    T* treeCounts = counts.data() + leafBegins[t];
+                    for (long blockBegin = 0; blockBegin < dataset.rows(); blockBegin += blockSize) {
+                        const long blockRowCount = std::min(blockSize, dataset.rows() - blockBegin);
+                        const T* blockData = dataset.data() + blockBegin * dataset.outerStride();
+                        if (dataset.outerStride() != dataset.cols()) {
+                            blockRows = dataset.middleRows(blockBegin, blockRowCount);
+                            blockData = blockRows.data();
+                        }
+                        search.findLeaves(blockData, blockRowCount, leaves.data(), sqDistances.data());
+                        for (long i = 0; i < blockRowCount; i++)
+                            treeCounts[leaves[i]]++;
+                    }
+                }
+            }
+
+            return counts;
+        }
+
+        /**
+         * Returns the region weights of all trees.
+         * @return The weights of all trees one after another, each in the order of the leaves in the buffer.
+         */
+        std::vector<T> getWeights() const {
+            std::vector<T> weights;
+            for (unsigned long t = 0; t < getNumberOfTrees(); t++) {
+                const auto& layout = treeLayout(t);
+                const auto* treeWeights = reinterpret_cast<const T*>(_data + layout.weightOffset);
+                weights.insert(weights.end(), treeWeights, treeWeights + layout.nLeaves);
+            }
+            return weights;
+        }
+
+        /**
+         * Updates the region weights of all trees to `decay * weight + change` and derives the region probabilities from the new weights like
+         * GeneralizedIsolationTree::fit, i.e. the weight of a region divided by the sum of all region weights of the tree and the number of dimensions. If the buffer
+         * is not owned exclusively by this forest (e.g. since it is memory-mapped), it is copied first.
+         * @param decay The factor, which the current weights are multiplied with (in [0, 1]).
+         * @param changes The changes of the weights in the layout of `getWeights` (e.g. the result of `countLeaves`). Weights are clamped to zero.
+         */
+        void updateWeights(T decay, const std::vector<T>& changes) {
+            const std::vector<std::uint64_t> leafBegins = leafBeginnings();
+            if (changes.size() != leafBegins.back())
+                throw std::runtime_error("CompiledForest::updateWeights: The number of changes needs to equal the number of leaves of all trees.");
+
+            unsigned char* data = writableData();
+            const auto nDimensions = static_cast<T>(getNumberOfDimensions());
+            for (unsigned long t = 0; t < getNumberOfTrees(); t++) {
+                const auto& layout = treeLayout(t);
+                auto* weights = reinterpret_cast<T*>(data + layout.weightOffset);
+                auto* probabilities = reinterpret_cast<T*>(data + layout.probabilityOffset);
+                T weightSum = 0;
+                for (std::uint64_t i = 0; i < layout.nLeaves; i++) {
+                    weights[i] = std::max<T>(decay * weights[i] + changes[leafBegins[t] + i], 0);
+                    weightSum += weights[i];
+                }
+                for (std::uint64_t i = 0; i < layout.nLeaves; i++)
+                    probabilities[i] = weightSum > 0 ? weights[i] / (weightSum * nDimensions) : 0;
+            }
+        }
+
+        /**
+         * Writes the region weights and probabilities of this forest into the models, which it has been compiled from.
+         * @param models The models (in the order of the trees).
+         */
+        void updateModels(std::vector<GIFModel<T>>& models) const {
+            if (models.size() != getNumberOfTrees())
+                throw std::runtime_error("CompiledForest::updateModels: The number of models needs to equal the number of trees.");
+            for (unsigned long t = 0; t < models.size(); t++) {
+                const auto& layout = treeLayout(t);
+                const auto* regions = reinterpret_cast<const std::uint32_t*>(_data + layout.regionOffset);
+                const auto* weights = reinterpret_cast<const T*>(_data + layout.weightOffset);
+                const auto* probabilities = reinterpret_cast<const T*>(_data + layout.probabilityOffset);
+                models[t].weightsPerRegion.resize(layout.nLeaves);
+                for (std::uint64_t i = 0; i < layout.nLeaves; i++) {
+                    models[t].weightsPerRegion[regions[i]] = weights[i];
+                    models[t].probabilitiesPerRegion[regions[i]] = probabilities[i];
+                }
+            }
+        }
+
+    private:
+        typedef std::vector<unsigned char, Eigen::aligned_allocator<unsigned char>> Buffer;
+
+        static const std::uint64_t _alignment = 64;
+        static const unsigned int _maxSearchTreeDepth = 64; // Median splits never exceed this depth, which keeps the search stack of LeafSearch::findLeaf small.
+
+        std::shared_ptr<const void> _owner;
+        const unsigned char* _data = nullptr;
+        bool _writable = false; // True, if the buffer has been allocated by this class (and may hence be modified, unless it is shared with a copy).
+
+        /**
+         * Predicts the probability of inlierness for every row of a dataset (see `predict`) into a given output.
+         * @param dataset The dataset to inspect.
+         * @param output Pointer to `dataset.rows()` entries, which receive the probabilities.
+         * @param workerCount Number of workers to consider.
+         */
+        void predict(const RowMatrixXRef<T>& dataset, T* output, unsigned int workerCount) const {
+            if (empty())
+                throw std::runtime_error("CompiledForest::predict: The forest does not hold any trees.");
+            if (static_cast<unsigned long>(dataset.cols()) != getNumberOfDimensions())
+                throw std::runtime_error("CompiledForest::predict: The dataset needs to have " + std::to_string(getNumberOfDimensions()) + " columns.");
+
+            const long blockSize = 256;
+            const long nBlocks = (dataset.rows() + blockSize - 1) / blockSize;
+            const auto nTrees = getNumberOfTrees();
+            Eigen::Map<VectorX<T>> y(output, dataset.rows());
+            y.setZero();
+
+            // Every tree is weighted relative to the average weight of all trees, i.e. by exactly one, unless forests have been merged.
+            double meanTreeWeight = 0;
+            for (unsigned long t = 0; t < nTrees; t++)
+                meanTreeWeight += treeLayout(t).treeWeight;
+            meanTreeWeight /= nTrees;
+            std::vector<T> treeFactors(nTrees);
+            for (unsigned long t = 0; t < nTrees; t++)
+                treeFactors[t] = static_cast<T>(treeLayout(t).treeWeight / meanTreeWeight);
+
+#pragma omp parallel num_threads(Tools::availableWorkerCount(workerCount))
+            {
+                RowMatrixX<T> blockRows;
+                std::vector<unsigned int> leaves(blockSize);
+                std::vector<T> sqDistances(blockSize);
+
+#pragma omp for schedule(dynamic)
+                for (long b = 0; b < nBlocks; b++) {
+                    const long blockBegin = b * blockSize;
+                    const long blockRowCount = std::min(blockSize, dataset.rows() - blockBegin);
+
+                    // Densely packed rows are scored in place, all other rows are copied into a contiguous buffer first.
+                    const T* blockData = dataset.data() + blockBegin * dataset.outerStride();
+                    if (dataset.outerStride() != dataset.cols()) {
+                        blockRows.resize(blockSize, dataset.cols());
+                        blockRows.topRows(blockRowCount) = dataset.middleRows(blockBegin, blockRowCount);
+                        blockData = blockRows.data();
+                    }
+
+                    // Query all trees for the rows of this block and average over their weighted predictions.
+                    for (unsigned long t = 0; t < nTrees; t++) {
+                        const auto& layout = treeLayout(t);
+                        const auto* probabilities = reinterpret_cast<const T*>(_data + layout.probabilityOffset);
+                        const T treeFactor = treeFactors[t];
+                        treeSearch(layout).findLeaves(blockData, blockRowCount, leaves.data(), sqDistances.data());
+                        for (long i = 0; i < blockRowCount; i++)
+                            y[blockBegin + i] += treeFactor * probabilities[leaves[i]];
+                    }
+                    y.segment(blockBegin, blockRowCount) /= static_cast<T>(nTrees);
+                }
+            }
+        }
+
+        /**
+         * Returns the index of the first leaf of every tree within the leaves of all trees, followed by the overall number of leaves.
+         */
+        std::vector<std::uint64_t> leafBeginnings() const {
+            std::vector<std::uint64_t> leafBegins(getNumberOfTrees() + 1, 0);
+            for (unsigned long t = 0; t < getNumberOfTrees(); t++)
+                leafBegins[t + 1] = leafBegins[t] + treeLayout(t).nLeaves;
+            return leafBegins;
+        }
+
+        /**
+         * Returns a pointer to the buffer, which may be modified. The buffer is copied, unless it has been allocated by this class and is not shared with a copy.
+         */
+        unsigned char* writableData() {
+            if (!_writable || _owner.use_count() > 1) {
+                auto buffer = std::make_shared<Buffer>(_data, _data + size());
+                _owner = buffer;
+                _data = buffer->data();
+                _writable = true;
+            }
+            return const_cast<unsigned char*>(_data);
+        }
+
+        /**
+         * Rounds an offset up to the next multiple of the alignment.
+         */
+        static std::uint64_t align(std::uint64_t offset) {
+            return (offset + _alignment - 1) / _alignment * _alignment;
+        }
+
+        /**
+         * Checks, whether the buffer is a valid compiled forest of the scalar type T, which fits into a given number of bytes. Every section needs to lie within the buffer and
+         * every index within its range, such that predictions never read outside of the buffer.
+         */
+        void validate(std::uint64_t size) const {
+            const auto& forestHeader = header();
+            if (forestHeader.magic != magic)
+                throw std::runtime_error("CompiledForest::validate: The buffer does not hold a compiled forest (or has been written on a host with a different byte order).");
+            if (forestHeader.version != formatVersion)
+                throw std::runtime_error("CompiledForest::validate: Unsupported format version " + std::to_string(forestHeader.version) + " (expected "
+                                         + std::to_string(formatVersion) + ").");
+            if (forestHeader.scalarSize != sizeof(T))
+                throw std::runtime_error("CompiledForest::validate: The forest has been compiled for a scalar type of " + std::to_string(forestHeader.scalarSize) + " bytes.");
+            if (forestHeader.size > size || forestHeader.nDimensions == 0 || forestHeader.nTrees == 0
+                || forestHeader.stride != LeafIndex<T>::paddedStride(forestHeader.nDimensions)
+                || !fits(forestHeader.treeTableOffset, forestHeader.nTrees, sizeof(CompiledTreeLayout)))
+                throw std::runtime_error("CompiledForest::validate: The buffer is truncated or corrupt.");
+
+            for (unsigned long t = 0; t < forestHeader.nTrees; t++) {
+                const auto& layout = treeLayout(t);
+                const std::uint64_t nLeaves = layout.nLeaves, nNodes = layout.nNodes;
+                bool valid = nLeaves > 0 && nLeaves <= std::numeric_limits<std::uint32_t>::max() && nNodes <= std::numeric_limits<std::uint32_t>::max()
+                             && (layout.searchMethod == static_cast<std::uint64_t>(LeafSearchMethod::BruteForce)
+                                 || (layout.searchMethod == static_cast<std::uint64_t>(LeafSearchMethod::SearchTree) && nNodes > 0))
+                             && layout.treeWeight > 0 && layout.treeWeight <= std::numeric_limits<double>::max()
+                             && fits(layout.leafOffset, nLeaves, forestHeader.stride * sizeof(T)) && fits(layout.probabilityOffset, nLeaves, sizeof(T))
+                             && fits(layout.countOffset, nLeaves, sizeof(std::uint64_t)) && fits(layout.weightOffset, nLeaves, sizeof(T))
+                             && fits(layout.regionOffset, nLeaves, sizeof(std::uint32_t))
+                             && fits(layout.splitValueOffset, nNodes, sizeof(T)) && fits(layout.splitDimensionOffset, nNodes, sizeof(std::int32_t))
+                             && fits(layout.firstOffset, nNodes, sizeof(std::uint32_t)) && fits(layout.secondOffset, nNodes, sizeof(std::uint32_t));
+                if (valid) {
+                    // Children of the search tree are stored after their parents, which also bounds the depth of the search (see LeafSearch::findLeaf).
+                    const LeafSearch<T> search = treeSearch(layout);
+                    for (std::uint64_t i = 0; i < nLeaves && valid; i++)
+                        valid = search.regions[i] < nLeaves;
+                    std::vector<unsigned int> depths(nNodes, 0);
+                    for (std::uint64_t i = 0; i < nNodes && valid; i++) {
+                        if (search.splitDimensions[i] < 0)
+                            valid = search.first[i] <= search.second[i] && search.second[i] <= nLeaves;
+                        else {
+                            valid = static_cast<std::uint64_t>(search.splitDimensions[i]) < forestHeader.nDimensions && search.first[i] > i && search.second[i] > i
+                                    && search.first[i] < nNodes && search.second[i] < nNodes && depths[i] < _maxSearchTreeDepth;
+                            if (valid) {
+                                depths[search.first[i]] = std::max(depths[search.first[i]], depths[i] + 1);
+                                depths[search.second[i]] = std::max(depths[search.second[i]], depths[i] + 1);
+                            }
+                        }
+                    }
+                }
+                if (!valid)
+                    throw std::runtime_error("CompiledForest::validate: The layout of tree " + std::to_string(t) + " is corrupt.");
+            }
+        }
+
+        /**
+         * Returns, whether `count` elements of `elementSize` bytes (which needs to be positive) starting at byte `offset` lie within the buffer and are aligned.
+         */
+        bool fits(std::uint64_t offset, std::uint64_t count, std::uint64_t elementSize) const {
+            const std::uint64_t size = header().size;
+            return elementSize > 0 && offset % _alignment == 0 && offset <= size && count <= (size - offset) / elementSize;
+        }
+
+        const CompiledForestHeader& header() const {
+            return *reinterpret_cast<const CompiledForestHeader*>(_data);
+        }
+
+        const CompiledTreeLayout& treeLayout(unsigned long tree) const {
+            return reinterpret_cast<const CompiledTreeLayout*>(_data + header().treeTableOffset)[tree];
+        }
+
+        /**
+         * Returns a view of the leaves and the search structure of a tree within the buffer.
+         */
+        LeafSearch<T> treeSearch(const CompiledTreeLayout& layout) const {
+            return {static_cast<LeafSearchMethod>(layout.searchMethod),
+                    layout.nLeaves,
+                    header().nDimensions,
+                    header().stride,
+                    reinterpret_cast<const T*>(_data + layout.leafOffset),
+                    reinterpret_cast<const std::uint32_t*>(_data + layout.regionOffset),
+                    reinterpret_cast<const T*>(_data + layout.splitValueOffset),
+                    reinterpret_cast<const std::int32_t*>(_data + layout.splitDimensionOffset),
+                    reinterpret_cast<const std::uint32_t*>(_data + layout.firstOffset),
+                    reinterpret_cast<const std::uint32_t*>(_data + layout.secondOffset)};
+        }
+    };
+
+    template<typename T>
+    const std::uint64_t CompiledForest<T>::magic;
+
+    template<typename T>
+    const std::uint64_t CompiledForest<T>::formatVersion;
+}
+
+#endif // GENIF_COMPILEDFOREST_H
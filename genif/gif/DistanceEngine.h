@@ -0,0 +1,254 @@
+#ifndef GENIF_DISTANCEENGINE_H
+#define GENIF_DISTANCEENGINE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <genif/io/DataTypeHandling.h>
+#include <limits>
+#include <vector>
+
+namespace genif {
+    /**
+     * The methods, which DistanceEngine may use to find the nearest representative of a vector.
+     */
+    enum class AssignmentMethod : std::uint32_t {
+        Exhaustive = 0, // Computes the distances to all representatives by matrix-matrix products.
+        TriangleInequality = 1 // Skips representatives, which cannot be nearest according to the triangle inequality (Elkan, "Using the triangle inequality to accelerate
+                               // k-means").
+    };
+
+    /**
+     * Assigns vectors of a dataset to their nearest representative (w.r.t. the squared euclidean distance). The engine operates on a subset of the dataset rows, which is
+     * given by a vector of row indices. Vectors are addressed by their position in that vector.
+     *
+     * Instead of computing the distances pair by pair, the engine expands \f$\|x - r\|_2^2 = \|x\|_2^2 - 2 x^T r + \|r\|_2^2\f$, whereas the inner products are computed as
+     * matrix-matrix products between a tile of gathered vectors and all representatives. The vectors and the representatives are centred on the mean of the
+     * representatives first, which keeps the cancellation of the expansion small and independent of the location of the data. Every representative, which may be nearest
+     * within the rounding error of the expansion, is then compared by its directly computed distance.
+     *
+     * For many representatives, the engine may alternatively compute the pairwise distances of the representatives once and then skip representative \f$r_j\f$ for a vector
+     * \f$x\f$, whenever \f$\|r_b - r_j\|_2 \geq 2 \|x - r_b\|_2\f$ holds for the nearest representative \f$r_b\f$ found so far, since \f$r_j\f$ cannot be nearer than
+     * \f$r_b\f$ then (see AssignmentMethod::TriangleInequality). The remaining distances are computed directly, which avoids the cancellation of the expansion above.
+     *
+     * @tparam T The scalar type of the dataset (float or double).
+     */
+    template<typename T>
+    class DistanceEngine {
+    public:
+        /**
+         * Constructs a DistanceEngine for a subset of a given dataset.
+         * @param dataset The dataset, whose vectors should be assigned. Its data needs to outlive the engine.
+         * @param rowIndices The dataset rows, which the engine operates on. The engine keeps a reference to it.
+         * @param method The method, which is used to find the nearest representatives (see `selectMethod`).
+         * @param tileSize The number of vectors, which are processed at once (e.g. by a single matrix-matrix product).
+         */
+        DistanceEngine(const RowMatrixXRef<T>& dataset, const std::vector<unsigned int>& rowIndices, AssignmentMethod method = AssignmentMethod::Exhaustive,
+                       unsigned int tileSize = 256) :
+            _dataset(dataset), _rowIndices(rowIndices), _method(method), _tileSize(tileSize) {
+            if (_tileSize < 1)
+                throw std::runtime_error("DistanceEngine::DistanceEngine: tileSize needs to be at least one.");
+        }
+
+        /**
+         * Chooses an assignment method for a given number of representatives. Matrix-matrix products evaluate few representatives faster than pruning could save, whereas
+         * the number of representatives, which can be skipped, grows with their number.
+         * @param k The number of representatives per assignment.
+         * @return As stated above.
+         */
+        static AssignmentMethod selectMethod(unsigned int k) {
+            if (k >= _minPruningRepresentatives)
+                return AssignmentMethod::TriangleInequality;
+            return AssignmentMethod::Exhaustive;
+        }
+
+        /**
+         * Determines the nearest representative for every given vector.
+         *
+         * The nearest representative is the one with the smallest directly computed squared distance, whereas ties are resolved in favor of the representative, which comes
+         * first in `representativeIndices`. All assignment methods yield this representative and its distance.
+         *
+         * @param vectorIndices Pointer to the indices of the vectors to assign.
+         * @param nVectors The number of vectors to assign.
+         * @param representativeIndices The vector indices of the representatives.
+         * @param labels Output array of size `nVectors`, which receives the position of the nearest representative in `representativeIndices`.
+         * @param sqDistances Output array of size `nVectors`, which receives the squared distance to the nearest representative.
+         * @param workerCount Number of workers to consider. Tiles are processed sequentially, if only one worker is given.
+         */
+        void assign(const unsigned int* vectorIndices, size_t nVectors, const std::vector<unsigned int>& representativeIndices, unsigned int* labels, T* sqDistances,
+                    unsigned int workerCount = 1) const {
+            const auto k = static_cast<unsigned int>(representativeIndices.size());
+            const auto d = _dataset.cols();
+            if (k == 0)
+                throw std::runtime_error("DistanceEngine::assign: At least one representative is required.");
+
+            // Gather the representatives once, since every tile is multiplied with them.
+            RowMatrixX<T> representatives(k, d);
+            for (unsigned int j = 0; j < k; j++)
+                representatives.row(j) = _dataset.row(_rowIndices[representativeIndices[j]]);
+
+            const long nTiles = static_cast<long>((nVectors + _tileSize - 1) / _tileSize);
+            long firstTile = 0;
+            if (_method == AssignmentMethod::TriangleInequality) {
+                // Compute a quarter of the pairwise squared distances of the representatives, such that r_j may be skipped, whenever the entry (b, j) is at least the
+                // squared distance to the nearest representative r_b found so far. Shrinking the entries by the rounding error of the distances keeps the result
+                // exact. Additionally, every vector, which is that close to r_b w.r.t. all other representatives, is assigned to r_b immediately.
+                const T shrinkage = T(1) - T(8) * static_cast<T>(d + 1) * std::numeric_limits<T>::epsilon();
+                MatrixX<T> quarterSqDistances(k, k);
+                VectorX<T> quarterSeparations = VectorX<T>::Constant(k, std::numeric_limits<T>::max());
+                for (unsigned int j = 0; j < k; j++) {
+                    quarterSqDistances(j, j) = 0.0;
+                    for (unsigned int l = 0; l < j; l++) {
+                        const T quarterSqDistance = (representatives.row(j) - representatives.row(l)).squaredNorm() / T(4) * shrinkage;
+                        quarterSqDistances(j, l) = quarterSqDistances(l, j) = quarterSqDistance;
+                        quarterSeparations[j] = std::min(quarterSeparations[j], quarterSqDistance);
+                        quarterSeparations[l] = std::min(quarterSeparations[l], quarterSqDistance);
+                    }
+                }
+
+                // Pruning only pays off, if the representatives are sufficiently separated w.r.t. the vectors. Hence, the first tile serves as a probe, and the remaining
+                // tiles are assigned exhaustively, if too many distances had to be computed for it. Both ways yield the same labels and distances (see `assign`).
+                const size_t nEvaluated = assignTilePruned(0, vectorIndices, nVectors, representatives, quarterSqDistances, quarterSeparations, labels, sqDistances);
+                firstTile = 1;
+                if (nEvaluated * _maxEvaluatedShare <= std::min<size_t>(_tileSize, nVectors) * k) {
+#pragma omp parallel for schedule(static) num_threads(workerCount) if (workerCount > 1 && nTiles > 2)
+                    for (long t = 1; t < nTiles; t++)
+                        assignTilePruned(t, vectorIndices, nVectors, representatives, quarterSqDistances, quarterSeparations, labels, sqDistances);
+                    return;
+                }
+            }
+
+            // Centre the representatives for the expansion.
+            const Eigen::Matrix<T, 1, Eigen::Dynamic> centre = representatives.colwise().mean();
+            const RowMatrixX<T> centredRepresentatives = representatives.rowwise() - centre;
+            const VectorX<T> representativeNorms = centredRepresentatives.rowwise().squaredNorm();
+
+            if (workerCount > 1 && nTiles - firstTile > 1) {
+#pragma omp parallel num_threads(workerCount)
+                {
+                    RowMatrixX<T> tile(_tileSize, d);
+                    MatrixX<T> innerProducts(_tileSize, k);
+
+#pragma omp for schedule(static)
+                    for (long t = firstTile; t < nTiles; t++)
+                        assignTile(t, vectorIndices, nVectors, representatives, centre, centredRepresentatives, representativeNorms, tile, innerProducts, labels, sqDistances);
+                }
+            } else {
+                const auto tileRows = std::min<size_t>(_tileSize, nVectors);
+                RowMatrixX<T> tile(tileRows, d);
+                MatrixX<T> innerProducts(tileRows, k);
+                for (long t = firstTile; t < nTiles; t++)
+                    assignTile(t, vectorIndices, nVectors, representatives, centre, centredRepresentatives, representativeNorms, tile, innerProducts, labels, sqDistances);
+            }
+        }
+
+        /**
+         * Returns the method, which is used to find the nearest representatives.
+         * @return As stated above.
+         */
+        AssignmentMethod getMethod() const {
+            return _method;
+        }
+
+    private:
+        static const unsigned int _minPruningRepresentatives = 32;
+        static const unsigned int _maxEvaluatedShare = 3; // Pruning is kept, if at most every _maxEvaluatedShare-th distance had to be computed for the probe tile.
+
+        RowMatrixXRef<T> _dataset;
+        const std::vector<unsigned int>& _rowIndices;
+        AssignmentMethod _method = AssignmentMethod::Exhaustive;
+        unsigned int _tileSize = 256;
+
+        /**
+         * Computes the squared euclidean distance between two vectors of the given dimensionality.
+         */
+        static T squaredDistance(const T* x1, const T* x2, Eigen::Index nDimensions) {
+            T dist = 0.0;
+#pragma omp simd reduction(+ : dist)
+            for (Eigen::Index j = 0; j < nDimensions; j++) {
+                const T diff = x1[j] - x2[j];
+                dist += diff * diff;
+            }
+            return dist;
+        }
+
+        /**
+         * Assigns the vectors of tile `t` to their nearest representatives, whereas representatives are skipped according to the triangle inequality. Representatives are
+         * visited in their given order and only replace the nearest one found so far, if they are strictly nearer. Skipped representatives cannot be strictly nearer,
+         * hence ties are resolved just like an exhaustive search does.
+         * @return The number of computed distances.
+         */
+        size_t assignTilePruned(long t, const unsigned int* vectorIndices, size_t nVectors, const RowMatrixX<T>& representatives, const MatrixX<T>& quarterSqDistances,
+                              const VectorX<T>& quarterSeparations, unsigned int* labels, T* sqDistances) const {
+            const auto k = static_cast<unsigned int>(representatives.rows());
+            const auto d = representatives.cols();
+            const size_t tileBegin = static_cast<size_t>(t) * _tileSize;
+            const size_t tileEnd = std::min<size_t>(tileBegin + _tileSize, nVectors);
+            size_t nEvaluated = 0;
+            for (size_t i = tileBegin; i < tileEnd; i++) {
+                const T* vector = _dataset.row(_rowIndices[vectorIndices[i]]).data();
+                unsigned int nearestIdx = 0;
+                T nearestDist = squaredDistance(vector, representatives.row(0).data(), d);
+                nEvaluated++;
+                for (unsigned int j = 1; j < k && nearestDist > quarterSeparations[nearestIdx]; j++) {
+                    if (quarterSqDistances(j, nearestIdx) >= nearestDist)
+                        continue;
+                    const T repDist = squaredDistance(vector, representatives.row(j).data(), d);
+                    nEvaluated++;
+                    if (repDist < nearestDist) {
+                        nearestDist = repDist;
+                        nearestIdx = j;
+                    }
+                }
+                labels[i] = nearestIdx;
+                sqDistances[i] = nearestDist;
+            }
+            return nEvaluated;
+        }
+
+        /**
+         * Assigns the vectors of tile `t` to their nearest representatives, using `tile` and `innerProducts` as scratch space. The representatives are given as they are
+         * and centred on `centre` (along with the squared norms of the centred representatives).
+         */
+        void assignTile(long t, const unsigned int* vectorIndices, size_t nVectors, const RowMatrixX<T>& representatives, const Eigen::Matrix<T, 1, Eigen::Dynamic>& centre,
+                        const RowMatrixX<T>& centredRepresentatives, const VectorX<T>& representativeNorms, RowMatrixX<T>& tile, MatrixX<T>& innerProducts,
+                        unsigned int* labels, T* sqDistances) const {
+            const auto k = static_cast<unsigned int>(representatives.rows());
+            const auto d = representatives.cols();
+            const size_t tileBegin = static_cast<size_t>(t) * _tileSize;
+            const auto tileRows = static_cast<unsigned int>(std::min<size_t>(_tileSize, nVectors - tileBegin));
+
+            // Gather and centre the vectors of this tile and compute their inner products with all representatives.
+            for (unsigned int i = 0; i < tileRows; i++)
+                tile.row(i) = _dataset.row(_rowIndices[vectorIndices[tileBegin + i]]) - centre;
+            innerProducts.topRows(tileRows).noalias() = tile.topRows(tileRows) * centredRepresentatives.transpose();
+
+            // The expanded distance to r_j differs from the directly computed one by at most errorFactor * (|x|^2 + |r_j|^2) (for the centred vectors), which bounds
+            // the rounding of the centring, the inner products, the norms and the direct computation. Hence, only representatives, whose lower bound does not exceed
+            // the smallest upper bound, may be nearest, and they are compared by their directly computed distances.
+            const T errorFactor = T(8) * static_cast<T>(d + 4) * std::numeric_limits<T>::epsilon();
+            for (unsigned int i = 0; i < tileRows; i++) {
+                const T vectorNorm = tile.row(i).squaredNorm();
+                T minUpperBound = std::numeric_limits<T>::max();
+                for (unsigned int j = 0; j < k; j++)
+                    minUpperBound = std::min(minUpperBound, vectorNorm - T(2) * innerProducts(i, j) + representativeNorms[j] + errorFactor * (vectorNorm + representativeNorms[j]));
+
+                const T* vector = _dataset.row(_rowIndices[vectorIndices[tileBegin + i]]).data();
+                unsigned int nearestIdx = 0;
+                T nearestDist = std::numeric_limits<T>::max();
+                for (unsigned int j = 0; j < k; j++) {
+                    if (vectorNorm - T(2) * innerProducts(i, j) + representativeNorms[j] - errorFactor * (vectorNorm + representativeNorms[j]) > minUpperBound)
+                        continue;
+                    const T repDist = squaredDistance(vector, representatives.row(j).data(), d);
+                    if (repDist < nearestDist) {
+                        nearestDist = repDist;
+                        nearestIdx = j;
+                    }
+                }
+                labels[tileBegin + i] = nearestIdx;
+                sqDistances[tileBegin + i] = nearestDist;
+            }
+        }
+    };
+}
+
+#endif // GENIF_DISTANCEENGINE_H
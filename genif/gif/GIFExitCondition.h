@@ -2,87 +2,187 @@
 #define GENIF_GIFEXITCONDITION_H
 
 #include "Tree.h"
+#include <cmath>
 #include <genif/kernels/Kernel.h>
 #include <genif/kernels/MaternKernel.h>
 #include <genif/kernels/RBFKernel.h>
+#include <genif/random/SplitMix64.h>
+#include <random>
 
 namespace genif {
     /**
-     * This class provides an interface to describe different exit conditions.
+     * An exit condition, which stops the recursion as soon as the average kernel function value of the vectors of a node w.r.t. its representative exceeds a threshold.
+     *
+     * Exit conditions are passed to GeneralizedIsolationTree as a template parameter and need to provide a method `bool shouldExitRecursion(const Tree<T>&, const TreeNode&)
+     * const`. For fitting trees for multiple thresholds at once (see GeneralizedIsolationTree::fitFamily), they additionally provide the exact average kernel value by
+     * `T averageKernelValue(const Tree<T>&, const TreeNode&) const`. Since the kernel type is a template parameter as well, the kernel is called directly and can be inlined
+     * into the loops of this class.
+     *
+     * Optionally, the average kernel value of large nodes is estimated from a growing random sample of the node's vectors. Since kernel values lie in
+     * `[0, kernel.getMaximumValue()]`, Hoeffding's inequality bounds the deviation of the sample mean from the exact average. The decision is taken from the sample as soon
+     * as the confidence interval lies entirely above or below sigma, otherwise the exact average is computed.
+     *
+     * @tparam T The scalar type of the dataset (float or double).
+     * @tparam KernelType The type of the kernel (e.g. RBFKernel<T> or MaternKernel<T, 3>).
      */
-    class GIFExitCondition {
+    template<typename T, typename KernelType>
+    class GIFExitConditionAverageKernelValue {
     public:
         /**
-         * Classes, which override this method, should return for a given node, whether a further recursion step should happen.
+         * Initializes an exit condition-decider using average kernel values in a specific data subregion.
+         * @param kernel The kernel to use.
+         * @param sigma Average kernel value, which should be exceeded for the exit condition to apply.
+         * @param delta The probability, that a decision taken from a sample of a node differs from the exact decision (0 disables sampling, i.e. the average is always
+         * computed exactly).
+         */
+        GIFExitConditionAverageKernelValue(KernelType kernel, T sigma, T delta = 0.0) : _kernel(std::move(kernel)), _sigma(sigma), _delta(delta) {
+            if (_delta < 0 || _delta >= 1)
+                throw std::runtime_error("GIFExitConditionAverageKernelValue::GIFExitConditionAverageKernelValue: delta needs to be in [0, 1).");
+        }
+
+        /**
+         * Tests, whether a node should be subject to another recursion step.
          *
-         * More specifically, the parametrized node is subject to a split in a next recursion step, so this method decides,
-         * whether this split should happen.
+         * Instances of GIFExitConditionAverageKernelValue, check, whether the average kernel function value of the vectors w.r.t to the representative
+         * in the node is greater than the specified sigma value and will only return true when this condition has been met. For radial kernels, the squared
+         * distances to the representative, which are stored in the node, are reused instead of evaluating the kernel on the vectors again. The kernel is always evaluated
+         * for whole blocks of vectors (see Kernel::sum and Kernel::sumFromSquaredDistances). If a positive delta has been given, the decision for large nodes is
+         * taken from a sample of the node's vectors, whenever the sample is conclusive.
          *
+         * @param tree The tree, which holds the vectors of the node.
          * @param node The node to make the decision for.
          * @return A decision, whether the next recursion step should happen.
          */
-        virtual bool shouldExitRecursion(const Tree& node) const = 0;
-    };
-
-    class GIFExitConditionAverageKernelValue : public GIFExitCondition {
-    public:
-        GIFExitConditionAverageKernelValue(const GIFExitConditionAverageKernelValue&) = delete;
-        GIFExitConditionAverageKernelValue& operator=(const GIFExitConditionAverageKernelValue&) = delete;
+        bool shouldExitRecursion(const Tree<T>& tree, const TreeNode& node) const {
+            bool decision;
+            if (_delta > 0 && node.size() >= 2 * _chunkSize && sampleDecision(tree, node, decision))
+                return decision;
+            return averageKernelValue(tree, node) >= _sigma;
+        }
 
         /**
-         * Initializes an exit condition-decider using average kernel values in a specific data subregion.
-         * @param kernelId Name of the kernel to use (possible value: rbf, matern-d1, matern-d3, matern-d5).
-         * @param kernelScaling Vector of scaling values for the kernel to be used (scalar for RBF, d-dimensional vector for Matern kernels - d being the number of dimensions of
-         * the input vectors).
-         * @param sigma Average kernel value, which should be exceeded for the exit condition to apply.
+         * Computes the exact average kernel function value of the vectors in a node w.r.t. to its representative.
+         * @param tree The tree, which holds the vectors of the node.
+         * @param node The node.
+         * @return As stated above.
          */
-        explicit GIFExitConditionAverageKernelValue(const std::string& kernelId, const VectorX& kernelScaling, data_t sigma) : _sigma(sigma) {
-            if (kernelId == "rbf") {
-                _kernel = new RBFKernel(kernelScaling[0]);
-            } else if (kernelId == "matern-d1") {
-                _kernel = new MaternKernel(kernelScaling, 1);
-            } else if (kernelId == "matern-d3") {
-                _kernel = new MaternKernel(kernelScaling, 3);
-            } else if (kernelId == "matern-d5") {
-                _kernel = new MaternKernel(kernelScaling, 5);
+        T averageKernelValue(const Tree<T>& tree, const TreeNode& node) const {
+            T accu = 0.0;
+            if (_kernel.isRadial()) {
+                accu = _kernel.sumFromSquaredDistances(&tree.representativeSqDistances[node.begin], node.size());
             } else {
-                throw std::runtime_error("GIFExitConditionAverageKernelValue::GIFExitConditionAverageKernelValue: Unknown kernel supplied ('" + kernelId
-                                         + "'). "
-                                           "Possible choices are: rbf, matern-d1, matern-d3, matern-d5.");
+                // Resolve the dataset rows of the node in chunks, which are then evaluated against the representative at once.
+                const T* representative = tree.row(node.representativeIndex).data();
+                unsigned int rowIndices[_chunkSize];
+                for (unsigned int chunkBegin = node.begin; chunkBegin < node.end; chunkBegin += _chunkSize) {
+                    const unsigned int chunkLength = std::min(_chunkSize, node.end - chunkBegin);
+                    for (unsigned int i = 0; i < chunkLength; i++)
+                        rowIndices[i] = tree.rowIndices[tree.vectorIndices[chunkBegin + i]];
+                    accu += _kernel.sum(representative, tree.dataset, rowIndices, chunkLength);
+                }
             }
-        };
+
+            return accu / static_cast<T>(node.size());
+        }
 
         /**
-         * Tests, whether a node should be subject to another recursion step.
-         *
-         * Instances of GIFExitConditionAverageKernelValue, check, whether the average kernel function value of the vectors w.r.t to the representative
-         * in the node is greater than the specified sigma value and will only return true when this condition has been met.
+         * Returns the kernel of this exit condition.
+         * @return As stated above.
          */
-        bool shouldExitRecursion(const Tree& node) const override {
-            auto* accuArray = new data_t[node.vectorIndices.size()];
-            for (unsigned int i = 0; i < node.vectorIndices.size(); i++)
-                accuArray[i] = _kernel->operator()(node.dataset.row(node.representativeIndex), node.dataset.row(node.vectorIndices[i]));
-
-            data_t accu = 0.0;
-#pragma omp simd reduction(+ : accu)
-            for (unsigned int i = 0; i < node.vectorIndices.size(); i++)
-                accu += accuArray[i];
-
-            delete[] accuArray;
-            return accu / static_cast<data_t>(node.vectorIndices.size()) >= _sigma;
+        const KernelType& getKernel() const {
+            return _kernel;
         }
 
         /**
-         * Destructor.
+         * Returns the average kernel value, which needs to be exceeded for the exit condition to apply.
+         * @return As stated above.
          */
-        virtual ~GIFExitConditionAverageKernelValue() {
-            delete _kernel;
+        T getSigma() const {
+            return _sigma;
+        }
+
+        /**
+         * Returns the probability, that a sampled decision differs from the exact decision (0 means, that sampling is disabled).
+         * @return As stated above.
+         */
+        T getDelta() const {
+            return _delta;
         }
 
     private:
-        Kernel* _kernel;
-        data_t _sigma = 1.0;
+        static const unsigned int _chunkSize = 256;
+        static const std::uint64_t _samplingStream = ~std::uint64_t(0); // The ordinal of the node's random stream for sampling (children use the ordinals 0 to k-1).
+
+        KernelType _kernel;
+        T _sigma = 1.0;
+        T _delta = 0.0;
+
+        /**
+         * Tries to take the decision from a random sample (drawn with replacement) of the node's vectors. The sample size starts at one chunk and is doubled, until the
+         * Hoeffding bound is conclusive or the sample would exceed half of the node. The i-th test (i = 1, 2, ...) is done with failure probability delta / 2^i, hence all tests
+         * together fail with probability at most delta. The sample only depends on the seed of the node, thus decisions do not depend on the number of workers.
+         * @param tree The tree, which holds the vectors of the node.
+         * @param node The node to make the decision for.
+         * @param decision Receives the decision, if the sample was conclusive.
+         * @return True, if the sample was conclusive.
+         */
+        bool sampleDecision(const Tree<T>& tree, const TreeNode& node, bool& decision) const {
+            const T maximumValue = _kernel.getMaximumValue();
+            if (!std::isfinite(maximumValue))
+                return false;
+
+            SplitMix64 generator(SplitMix64::split(node.seed, _samplingStream));
+            std::uniform_int_distribution<unsigned int> distribution(node.begin, node.end - 1);
+            unsigned int positions[_chunkSize];
+            T accu = 0.0;
+            T testDelta = _delta;
+            size_t nSamples = 0;
+            for (size_t sampleSize = _chunkSize; 2 * sampleSize <= node.size(); sampleSize *= 2) {
+                for (; nSamples < sampleSize; nSamples += _chunkSize) {
+                    for (unsigned int i = 0; i < _chunkSize; i++)
+                        positions[i] = distribution(generator);
+                    accu += sumAtPositions(tree, node, positions, _chunkSize);
+                }
+
+                // Hoeffding: P(|mean - E[mean]| >= epsilon) <= 2 exp(-2 n epsilon^2 / maximumValue^2).
+                testDelta /= 2;
+                const T mean = accu / static_cast<T>(nSamples);
+                const T epsilon = maximumValue * std::sqrt(std::log(T(2) / testDelta) / (T(2) * static_cast<T>(nSamples)));
+                if (mean - epsilon >= _sigma || mean + epsilon < _sigma) {
+                    decision = mean >= _sigma;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Returns the sum of the kernel values between the representative of a node and the vectors at given positions of the node.
+         * @param tree The tree, which holds the vectors of the node.
+         * @param node The node.
+         * @param positions Pointer to the positions (see Tree::vectorIndices) of the vectors.
+         * @param n The number of positions (at most one chunk).
+         * @return As stated above.
+         */
+        T sumAtPositions(const Tree<T>& tree, const TreeNode& node, const unsigned int* positions, unsigned int n) const {
+            if (_kernel.isRadial()) {
+                T sqDistances[_chunkSize];
+                for (unsigned int i = 0; i < n; i++)
+                    sqDistances[i] = tree.representativeSqDistances[positions[i]];
+                return _kernel.sumFromSquaredDistances(sqDistances, n);
+            }
+            unsigned int rowIndices[_chunkSize];
+            for (unsigned int i = 0; i < n; i++)
+                rowIndices[i] = tree.rowIndices[tree.vectorIndices[positions[i]]];
+            return _kernel.sum(tree.row(node.representativeIndex).data(), tree.dataset, rowIndices, n);
+        }
     };
+
+    template<typename T, typename KernelType>
+    const unsigned int GIFExitConditionAverageKernelValue<T, KernelType>::_chunkSize;
+
+    template<typename T, typename KernelType>
+    const std::uint64_t GIFExitConditionAverageKernelValue<T, KernelType>::_samplingStream;
 }
 
 #endif // GENIF_GIFEXITCONDITION_H
@@ -1,23 +1,50 @@
 #ifndef GENIF_GIF_GIFMODEL_H
 #define GENIF_GIF_GIFMODEL_H
 
-#include <nanoflann.hpp>
+#include "LeafIndex.h"
+#include <genif/io/DataTypeHandling.h>
+#include <memory>
 
 namespace genif {
     /**
      * A struct comprising the model information for Generalized Isolation Forests.
+     * @tparam T The scalar type of the summary vectors and probabilities (float or double).
      */
+    template<typename T>
     struct GIFModel {
-        std::vector<data_t> probabilitiesPerRegion;
+        std::vector<T> probabilitiesPerRegion;
         std::vector<unsigned long> countsPerRegion;
-        std::shared_ptr<MatrixX> dataMatrix;
-        std::shared_ptr<nanoflann::KDTreeEigenMatrixAdaptor<MatrixX>> dataKDTree;
+        std::vector<T> weightsPerRegion;
+        double treeWeight = 1.0; // The weight of the tree in the average over the trees of a forest (one, unless forests have been merged, see GeneralizedIsolationForest::merge).
+        std::shared_ptr<MatrixX<T>> dataMatrix;
+        std::shared_ptr<LeafIndex<T>> leafIndex;
+
+        /**
+         * Finds the region, which a vector falls into, i.e. the index of the nearest summary vector.
+         * @param vector Pointer to the vector (as many contiguous entries as the summary vectors have dimensions).
+         * @return As stated above.
+         */
+        size_t findRegion(const T* vector) const {
+            return leafIndex->findRegion(vector);
+        }
+
+        /**
+         * Finds the regions for a set of dataset rows (see LeafIndex::findRegions).
+         * @param dataset The dataset, which holds the vectors.
+         * @param rowIndices Pointer to the indices of the rows to query or `nullptr` to query the rows `0, ..., nRows - 1`.
+         * @param nRows The number of rows to query.
+         * @param regions Output array of size `nRows`, which receives the region of every queried row.
+         * @param workerCount Number of workers to consider.
+         */
+        void findRegions(const RowMatrixXRef<T>& dataset, const unsigned int* rowIndices, size_t nRows, unsigned int* regions, unsigned int workerCount) const {
+            leafIndex->findRegions(dataset, rowIndices, nRows, regions, workerCount);
+        }
 
         /**
          * Returns a vector of probabiltities for each found region (higher probability indicate inlierness).
          * @return As stated above.
          */
-        const std::vector<data_t>& getProbabilitiesPerRegion() const {
+        const std::vector<T>& getProbabilitiesPerRegion() const {
             return probabilitiesPerRegion;
         };
 
@@ -28,6 +55,15 @@ namespace genif {
         const std::vector<unsigned long>& getCountsPerRegion() const {
             return countsPerRegion;
         };
+
+        /**
+         * Returns a vector of weights for each found region, which the probabilities are derived from. After fitting, the weights equal the counts, updates of the
+         * forest may decay them and add new observations (see GeneralizedIsolationForest::update).
+         * @return As stated above.
+         */
+        const std::vector<T>& getWeightsPerRegion() const {
+            return weightsPerRegion;
+        };
     };
 }
 
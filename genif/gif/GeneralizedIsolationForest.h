@@ -6,11 +6,67 @@
 #include <genif/Learner.h>
 #include <genif/OutlierDetectionResult.h>
 #include <genif/Tools.h>
+#include <genif/gif/CompiledForest.h>
 #include <genif/gif/GIFModel.h>
+#include <genif/io/MappedFile.h>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <numeric>
 
 namespace genif {
-    class GeneralizedIsolationForest : public Learner<std::vector<GIFModel>, VectorX> {
+    /**
+     * Describes a serialized GeneralizedIsolationForest (see GeneralizedIsolationForest::serialize). The header is followed by the kernel name, the kernel scaling values and
+     * the buffer of the compiled forest (see CompiledForestHeader). The compiled forest starts at a multiple of 64 bytes, such that it can be used in place after reading or
+     * memory-mapping the whole file. All values are stored in the byte order of the host.
+     */
+    struct GeneralizedIsolationForestHeader {
+        std::uint64_t magic; // The ASCII characters "GIFOREST" (see GeneralizedIsolationForest::magic).
+        std::uint64_t version; // The version of the format (see GeneralizedIsolationForest::formatVersion).
+        std::uint64_t scalarSize; // The size of the scalar type in bytes (4 for float, 8 for double).
+        std::uint64_t k; // The parameters of the forest (see GeneralizedIsolationForest::Parameters).
+        std::uint64_t nModels;
+        std::uint64_t sampleSize;
+        std::int64_t workerCount; // Informational only, a restored forest uses the worker count of its host (see GeneralizedIsolationForest::deserialize).
+        std::int64_t seed;
+        std::uint64_t nextModelIndex; // The index of the random stream of the next added tree (see BaggingEnsemble::addModels).
+        std::uint64_t nObservations; // The number of observations, which the forest represents (see GeneralizedIsolationForest::merge).
+        double sigma;
+        double approximationDelta;
+        std::uint64_t kernelIdOffset; // The byte offset of the kernel name.
+        std::uint64_t kernelIdLength; // The number of characters of the kernel name.
+        std::uint64_t kernelScalingOffset; // The byte offset of the kernel scaling values.
+        std::uint64_t kernelScalingLength; // The number of kernel scaling values (scalar values).
+        std::uint64_t forestOffset; // The byte offset of the compiled forest.
+        std::uint64_t forestSize; // The size of the compiled forest in bytes (zero, if the forest has not been fitted).
+    };
+
+    /**
+     * A Generalized Isolation Forest, i.e. a bagging ensemble of Generalized Isolation Trees, which is compiled for prediction after fitting.
+     * @tparam T The scalar type of the data (float or double). Single precision halves the memory traffic of all distance and kernel computations.
+     */
+    template<typename T>
+    class GeneralizedIsolationForest : public Learner<std::vector<GIFModel<T>>, VectorX<T>, T> {
     public:
+        static const std::uint64_t magic = 0x545345524F464947; // The ASCII characters "GIFOREST" in little-endian byte order.
+        static const std::uint64_t formatVersion = 5; // The version of the format, which needs to be increased with every change of GeneralizedIsolationForestHeader.
+
+        /**
+         * The parameters of a GeneralizedIsolationForest (see the constructor for a description).
+         */
+        struct Parameters {
+            unsigned int k;
+            unsigned int nModels;
+            unsigned int sampleSize;
+            std::string kernelId;
+            VectorX<T> kernelScaling;
+            T sigma;
+            int workerCount;
+            int seed;
+            T approximationDelta;
+        };
+
         /**
          * Instantiates a GeneralizedIsolationForest.
          * @param k The number of representatives to find for each node of the tree.
@@ -22,63 +78,493 @@ namespace genif {
          * @param sigma Average pairwise kernel values of observations in a data sub-region, which should be exceeded for the exit condition to apply.
          * @param workerCount Number of parallel workers to consider (-1 defaults to all available cores).
          * @param seed Seed to use for random number generation (-1 defaults to sysclock seed). Pass an integer for constant result across multiple runs.
+         * @param approximationDelta If positive, the exit condition of large nodes is evaluated on a random sample of the node, which yields the exact decision with
+         * probability of at least 1 - approximationDelta (0 disables the approximation).
+         */
+        GeneralizedIsolationForest(unsigned int k, unsigned int nModels, unsigned int sampleSize, const std::string& kernelId, const VectorX<T>& kernelScaling, T sigma,
+                                   int workerCount = -1, int seed = -1, T approximationDelta = 0.0) :
+            GeneralizedIsolationForest(Parameters{k, nModels, sampleSize, kernelId, kernelScaling, sigma, workerCount, seed, approximationDelta}) {
+        }
+
+        /**
+         * Instantiates a GeneralizedIsolationForest.
+         * @param parameters The parameters of the forest.
          */
-        GeneralizedIsolationForest(unsigned int k, unsigned int nModels, unsigned int sampleSize, const std::string& kernelId, const VectorX& kernelScaling, data_t sigma,
-                                   int workerCount = -1, int seed = -1) :
-            _exitCondition(kernelId, kernelScaling, sigma),
-            _gTree(k, _exitCondition, genif::Tools::handleWorkerCount(workerCount), seed), _gtrBagging(_gTree, nModels, sampleSize, genif::Tools::handleWorkerCount(workerCount), seed) {
+        explicit GeneralizedIsolationForest(const Parameters& parameters) :
+            _parameters(parameters), _workerCount(genif::Tools::handleWorkerCount(parameters.workerCount)),
+            _gTree(makeTree(parameters.k, parameters.kernelId, parameters.kernelScaling, parameters.sigma, parameters.approximationDelta, _workerCount, parameters.seed)),
+            _gtrBagging(*_gTree, parameters.nModels, parameters.sampleSize, _workerCount, parameters.seed) {
         }
 
         /**
-         * Fits all trees.
+         * Fits all trees and compiles them for prediction.
          * @param dataset The dataset to use for fitting.
          * @return A reference to this object.
          */
-        Learner<std::vector<GIFModel>, VectorX>& fit(const MatrixX& dataset) override {
+        Learner<std::vector<GIFModel<T>>, VectorX<T>, T>& fit(const RowMatrixXRef<T>& dataset) override {
             _gtrBagging.fit(dataset);
+            _compiledForest = CompiledForest<T>(_gtrBagging.getModels());
+            _window.clear();
+            return *this;
+        }
+
+        /**
+         * Fits all trees using rows, which are read from a source (e.g. a file, see RowReader), and compiles them for prediction. Only the sampled rows are kept in
+         * memory, hence the source may be far larger than the memory. If the source knows its number of rows, the trees equal the trees of `fit` on the whole dataset
+         * (see BaggingEnsemble::fit).
+         * @param reader The source of the rows.
+         * @return A reference to this object.
+         */
+        Learner<std::vector<GIFModel<T>>, VectorX<T>, T>& fit(RowReader<T>& reader) {
+            _gtrBagging.fit(reader);
+            _compiledForest = CompiledForest<T>(_gtrBagging.getModels());
+            _window.clear();
+            return *this;
+        }
+
+        /**
+         * Fits additional trees and appends them to the existing ones, which are not changed (see BaggingEnsemble::addModels). The trees continue the random streams of
+         * `fit`, hence fitting `nModels` trees and adding `n` trees yields the same forest as fitting `nModels + n` trees at once (for the same seed and dataset). The
+         * score remains the plain average over all trees, i.e. every new tree counts as much as every tree of `fit`, regardless of the size of `dataset`. The sliding
+         * window of `update` restarts.
+         * @param dataset The dataset to use for fitting the new trees.
+         * @param nModels The number of trees to add.
+         * @return A reference to this object.
+         */
+        Learner<std::vector<GIFModel<T>>, VectorX<T>, T>& addModels(const RowMatrixXRef<T>& dataset, unsigned int nModels) {
+            restoreModels();
+            _gtrBagging.addModels(dataset, nModels);
+            _compiledForest = CompiledForest<T>(_gtrBagging.getModels());
+            _window.clear();
+            return *this;
+        }
+
+        /**
+         * Replaces selected trees (e.g. the oldest ones) by newly fitted trees, which continue the random streams and are averaged like in `addModels`. All other trees
+         * are not changed. The sliding window of `update` restarts.
+         * @param dataset The dataset to use for fitting the new trees.
+         * @param modelIndices The positions of the trees to replace.
+         * @return A reference to this object.
+         */
+        Learner<std::vector<GIFModel<T>>, VectorX<T>, T>& replaceModels(const RowMatrixXRef<T>& dataset, const std::vector<unsigned int>& modelIndices) {
+            restoreModels();
+            _gtrBagging.replaceModels(dataset, modelIndices);
+            _compiledForest = CompiledForest<T>(_gtrBagging.getModels());
+            _window.clear();
             return *this;
         }
 
+        /**
+         * Adapts the forest to new observations without changing the trees, e.g. in case of a concept drift.
+         *
+         * Every row is routed to its region in every tree. The weight of every region (initially the number of training vectors in it, see
+         * GIFModel::getWeightsPerRegion) is multiplied by `decay` and increased by the number of new rows in it. The probabilities are then derived from the weights as
+         * after fitting. Hence, a decay of one accumulates all observations, whereas smaller values let older observations fade out exponentially. Additionally, the
+         * weights may be restricted to a sliding window of the latest updates (the weights before the first windowed update count as one update). The probabilities of the
+         * compiled forest are updated in place. The window is not stored by `serialize`. This method must not be called concurrently with `predict`.
+         *
+         * @param dataset The new observations.
+         * @param decay The factor, which the current weights are multiplied with (in [0, 1]).
+         * @param windowSize The number of latest updates (including this one), which contribute to the weights (0 disables the window).
+         */
+        void update(const RowMatrixXRef<T>& dataset, T decay = 1.0, unsigned int windowSize = 0) {
+            if (_compiledForest.empty())
+                throw std::runtime_error("GeneralizedIsolationForest::update: Number of models is insufficient (maybe forgot to call `fit`?).");
+            if (!(decay >= 0 && decay <= 1))
+                throw std::runtime_error("GeneralizedIsolationForest::update: decay needs to be in [0, 1].");
+
+            std::vector<T> changes = _compiledForest.countLeaves(dataset, _workerCount);
+            if (windowSize > 0) {
+                // The weights are the decayed sum of the updates in the window, hence the update, which leaves the window, is subtracted with its accumulated decay.
+                if (_window.empty())
+                    _window.push_back(_compiledForest.getWeights());
+                _window.push_back(changes);
+                while (_window.size() > windowSize) {
+                    const T expiredDecay = std::pow(decay, static_cast<T>(_window.size() - 1));
+                    for (size_t i = 0; i < changes.size(); i++)
+                        changes[i] -= expiredDecay * _window.front()[i];
+                    _window.pop_front();
+                }
+            } else {
+                _window.clear();
+            }
+            _compiledForest.updateWeights(decay, changes);
+
+            // Keep the fitted models in sync with the compiled forest.
+            if (_gtrBagging.getActualNumberOfModels() > 0) {
+                std::vector<GIFModel<T>> models = _gtrBagging.getModel();
+                _compiledForest.updateModels(models);
+                _gtrBagging.setModels(std::move(models));
+            }
+        }
+
+        /**
+         * Fits one set of trees per sigma value at roughly the cost of a single fit, e.g. to tune sigma.
+         *
+         * Every tree is induced only once for the largest sigma value, the trees of the other sigma values are cut out of it (see GeneralizedIsolationTree::fitFamily). The
+         * samples and random streams are the same as for `fit`, hence every set of trees equals the result of `fit` with the respective sigma value (provided that the exit
+         * condition is evaluated exactly, i.e. approximationDelta is zero). The models of this forest are not modified.
+         *
+         * @param dataset The dataset to use for fitting.
+         * @param sigmas The sigma values (in any order).
+         * @return One vector of GIFModels per sigma value (in the order of `sigmas`), which may be passed to `predict`.
+         */
+        std::vector<std::vector<GIFModel<T>>> fitSigmas(const RowMatrixXRef<T>& dataset, const std::vector<T>& sigmas) const {
+            if (sigmas.empty())
+                throw std::runtime_error("GeneralizedIsolationForest::fitSigmas: At least one sigma value is required.");
+
+            // Trees are induced for the sigma values in ascending order.
+            std::vector<size_t> order(sigmas.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&sigmas](size_t a, size_t b) { return sigmas[a] < sigmas[b]; });
+            std::vector<T> sortedSigmas(sigmas.size());
+            for (size_t i = 0; i < order.size(); i++)
+                sortedSigmas[i] = sigmas[order[i]];
+
+            const std::vector<std::vector<GIFModel<T>>> families = _gtrBagging.template fitSamples<std::vector<GIFModel<T>>>(
+                dataset, [&dataset, &sortedSigmas](Learner<GIFModel<T>, OutlierDetectionResult<T>, T>& learner, const std::vector<unsigned int>& sampleIndices) {
+                    return static_cast<GeneralizedIsolationTreeLearner<T>&>(learner).fitFamily(dataset, sampleIndices, sortedSigmas);
+                });
+
+            // Regroup the models by sigma value.
+            std::vector<std::vector<GIFModel<T>>> models(sigmas.size(), std::vector<GIFModel<T>>(families.size()));
+            for (size_t m = 0; m < families.size(); m++)
+                for (size_t i = 0; i < order.size(); i++)
+                    models[order[i]][m] = families[m][i];
+            return models;
+        }
+
         /**
          * Predicts the outlierness of a dataset by inspecting the learned forest of trees.
          * @param dataset The dataset to inspect.
          * @return A vector, which indicates the probability of inlierness for every input vector.
          */
-        VectorX predict(const MatrixX& dataset) const override {
-            if(_gtrBagging.getActualNumberOfModels() > 0) {
-                // Get predictions.
-                const std::vector<OutlierDetectionResult>& predictions = _gtrBagging.predict(dataset);
-
-                // Average over predictions.
-                VectorX y(dataset.rows());
-                for (unsigned int i = 0; i < dataset.rows(); i++) {
-                    data_t predictionSum = 0.0;
-                    for (unsigned int j = 0; j < _gtrBagging.getActualNumberOfModels(); j++)
-                        predictionSum += predictions[j].getProbabilities()[i];
-                    y[i] = predictionSum / static_cast<data_t>(_gtrBagging.getActualNumberOfModels());
-                }
-                return y;
-            } else throw std::runtime_error("GeneralizedIsolationForest::predict: Number of models is insufficient (maybe forgot to call `fit`?).");
+        VectorX<T> predict(const RowMatrixXRef<T>& dataset) const override {
+            if (_compiledForest.empty())
+                throw std::runtime_error("GeneralizedIsolationForest::predict: Number of models is insufficient (maybe forgot to call `fit`?).");
+            return _compiledForest.predict(dataset, _workerCount);
+        }
+
+        /**
+         * Predicts the outlierness of a dataset by inspecting a given vector of trees (e.g. one of the results of `fitSigmas`). The trees are compiled for this call.
+         * @param dataset The dataset to inspect.
+         * @param models The trees to use.
+         * @return A vector, which indicates the probability of inlierness for every input vector.
+         */
+        VectorX<T> predict(const RowMatrixXRef<T>& dataset, const std::vector<GIFModel<T>>& models) const override {
+            if (models.empty())
+                throw std::runtime_error("GeneralizedIsolationForest::predict: Number of models is insufficient.");
+            return CompiledForest<T>(models).predict(dataset, _workerCount);
+        }
+
+        /**
+         * Predicts the outlierness of rows, which are consumed chunk by chunk from a source (e.g. a file, see RowReader), such that datasets of arbitrary size can be scored
+         * with bounded memory. Reading the next chunk overlaps with scoring the current one.
+         * @param reader The source of the rows.
+         * @param output Receives the probability of inlierness for every row. It needs to provide an entry for every row of the source.
+         * @param chunkRows The number of rows per chunk.
+         * @return The number of rows, which have been scored.
+         */
+        std::uint64_t predict(RowReader<T>& reader, VectorXRef<T> output, unsigned long chunkRows = 65536) const {
+            if (_compiledForest.empty())
+                throw std::runtime_error("GeneralizedIsolationForest::predict: Number of models is insufficient (maybe forgot to call `fit`?).");
+            return _compiledForest.predict(reader, output, chunkRows, _workerCount);
+        }
+
+        /**
+         * Returns the compiled representation of the learned forest, which is used for prediction.
+         * @return As stated above.
+         */
+        const CompiledForest<T>& getCompiledForest() const {
+            return _compiledForest;
         }
 
         /**
-         * Returns the learned vector of GIFModels i.e. the trees.
+         * Returns the learned vector of GIFModels i.e. the trees. The models of a deserialized forest are recovered from its compiled representation.
          * @return As stated above.
          */
-        std::vector<GIFModel> getModel() const override {
+        std::vector<GIFModel<T>> getModel() const override {
+            if (_gtrBagging.getActualNumberOfModels() == 0)
+                return _compiledForest.getModels();
             return _gtrBagging.getModel();
         }
 
+        /**
+         * Returns the parameters of this forest.
+         * @return As stated above.
+         */
+        const Parameters& getParameters() const {
+            return _parameters;
+        }
+
+        /**
+         * Returns the number of workers, which are used to fit the trees and to make predictions.
+         * @return As stated above.
+         */
+        unsigned int getWorkerCount() const {
+            return _workerCount;
+        }
+
+        /**
+         * Sets the number of workers, which are used to fit the trees and to make predictions (e.g. after restoring a forest on a different host).
+         * @param workerCount Number of workers to consider.
+         */
+        void setWorkerCount(unsigned int workerCount) override {
+            if (workerCount < 1)
+                throw std::runtime_error("GeneralizedIsolationForest::setWorkerCount: workerCount needs to be at least one.");
+            _workerCount = workerCount;
+            _parameters.workerCount = static_cast<int>(workerCount);
+            _gTree->setWorkerCount(workerCount);
+            _gtrBagging.setWorkerCount(workerCount);
+        }
+
+        /**
+         * Serializes the parameters and the compiled representation of the fitted trees into a buffer (see GeneralizedIsolationForestHeader), which can be passed to
+         * `deserialize`.
+         * @return As stated above.
+         */
+        std::vector<unsigned char> serialize() const {
+            std::vector<unsigned char> buffer = serializeHeader();
+            buffer.insert(buffer.end(), _compiledForest.data(), _compiledForest.data() + _compiledForest.size());
+            return buffer;
+        }
+
+        /**
+         * Restores a forest from a buffer, which has been created by `serialize`. The compiled trees are used as they are stored, i.e. their search structures are not
+         * rebuilt. The worker count, which the forest has been stored with, is not used, as it depends on the host, which has fitted the forest.
+         * @param data Pointer to the buffer.
+         * @param size The number of available bytes at `data`.
+         * @param owner An object, which keeps the buffer alive. If given, the compiled trees are used in place, otherwise they are copied (see CompiledForest::fromBuffer).
+         * @param workerCount Number of parallel workers to consider (-1 defaults to all available cores).
+         * @return As stated above.
+         */
+        static std::unique_ptr<GeneralizedIsolationForest> deserialize(const unsigned char* data, std::uint64_t size, std::shared_ptr<const void> owner = nullptr,
+                                                                      int workerCount = -1) {
+            GeneralizedIsolationForestHeader header;
+            if (size < sizeof(header))
+                throw std::runtime_error("GeneralizedIsolationForest::deserialize: The buffer is too small.");
+            std::memcpy(&header, data, sizeof(header));
+            if (header.magic != magic)
+                throw std::runtime_error("GeneralizedIsolationForest::deserialize: The buffer does not hold a forest (or has been written on a host with a different byte order).");
+            if (header.version != formatVersion)
+                throw std::runtime_error("GeneralizedIsolationForest::deserialize: Unsupported format version " + std::to_string(header.version) + " (expected "
+                                         + std::to_string(formatVersion) + ").");
+            if (header.scalarSize != sizeof(T))
+                throw std::runtime_error("GeneralizedIsolationForest::deserialize: The forest has been stored for a scalar type of " + std::to_string(header.scalarSize)
+                                         + " bytes.");
+            if (header.kernelIdOffset > size || header.kernelIdLength > size - header.kernelIdOffset || header.kernelScalingOffset > size
+                || header.kernelScalingLength > (size - header.kernelScalingOffset) / sizeof(T) || header.forestOffset > size || header.forestSize > size - header.forestOffset)
+                throw std::runtime_error("GeneralizedIsolationForest::deserialize: The buffer is truncated or corrupt.");
+            if (workerCount < -1 || workerCount > static_cast<int>(Tools::handleWorkerCount(-1)))
+                throw std::runtime_error("GeneralizedIsolationForest::deserialize: The worker count " + std::to_string(workerCount)
+                                         + " is neither -1 nor within the number of available cores.");
+
+            Parameters parameters = {static_cast<unsigned int>(header.k), static_cast<unsigned int>(header.nModels), static_cast<unsigned int>(header.sampleSize),
+                                     std::string(reinterpret_cast<const char*>(data + header.kernelIdOffset), header.kernelIdLength),
+                                     VectorX<T>(header.kernelScalingLength), static_cast<T>(header.sigma), workerCount,
+                                     static_cast<int>(header.seed), static_cast<T>(header.approximationDelta)};
+            std::memcpy(parameters.kernelScaling.data(), data + header.kernelScalingOffset, header.kernelScalingLength * sizeof(T));
+
+            auto forest = std::make_unique<GeneralizedIsolationForest>(parameters);
+            if (header.forestSize > 0)
+                forest->_compiledForest = CompiledForest<T>::fromBuffer(data + header.forestOffset, header.forestSize, std::move(owner));
+            forest->_gtrBagging.setNextModelIndex(static_cast<unsigned int>(header.nextModelIndex));
+            forest->_gtrBagging.setNumberOfObservations(header.nObservations);
+            return forest;
+        }
+
+        /**
+         * Writes the forest to a file (see `serialize`).
+         * @param path The path of the file.
+         */
+        void save(const std::string& path) const {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            const std::vector<unsigned char> header = serializeHeader();
+            file.write(reinterpret_cast<const char*>(header.data()), header.size());
+            file.write(reinterpret_cast<const char*>(_compiledForest.data()), _compiledForest.size());
+            if (!file)
+                throw std::runtime_error("GeneralizedIsolationForest::save: Could not write to '" + path + "'.");
+        }
+
+        /**
+         * Reads a forest from a file, which has been written by `save`. On POSIX systems, the file is memory-mapped read-only and the compiled trees are used directly
+         * from the mapped pages (see MappedFile). Hence, all processes, which load the same file, share a single physical copy of the trees, and loading does not depend
+         * on the size of the forest. The file must not be modified while the forest is in use.
+         * @param path The path of the file.
+         * @param workerCount Number of parallel workers to consider (-1 defaults to all available cores, see `deserialize`).
+         * @return As stated above.
+         */
+        static std::unique_ptr<GeneralizedIsolationForest> load(const std::string& path, int workerCount = -1) {
+            auto file = std::make_shared<MappedFile>(path);
+            return deserialize(file->data(), file->size(), file, workerCount);
+        }
+
+        /**
+         * Merges forests, which have been fitted independently (e.g. on the shards of a dataset in separate processes and then deserialized), into a single forest.
+         *
+         * The merged forest comprises the trees of all forests. Its score equals the average of the scores of the forests, weighted by the numbers of observations, which
+         * they represent, i.e. `sum_s n_s / N * score_s` for `N = sum_s n_s`. Here, `n_s` is the number of rows of the dataset, which forest `s` has been fitted on
+         * latest (see BaggingEnsemble::getNumberOfObservations). For this purpose, the trees of forest `s` are weighted with `T * n_s / (N * T_s)` relative to their
+         * previous weights (see GIFModel::treeWeight) for `T_s` of all `T` trees, such that the average weight of all trees is one. The merged forest represents `N`
+         * observations. Trees, which are added to it later on, have a weight of one, i.e. they count as much as an average merged tree.
+         *
+         * The forests need to agree on all parameters, which affect the trees (k, kernel, kernel scaling, sigma, sample size and approximation delta), and on the number
+         * of dimensions. The seed and the number of workers are taken from the first forest and the number of trees is the total number of trees. Added trees continue
+         * the random streams after the latest stream of all forests.
+         *
+         * @param forests The fitted forests.
+         * @return As stated above.
+         */
+        static std::unique_ptr<GeneralizedIsolationForest> merge(const std::vector<const GeneralizedIsolationForest*>& forests) {
+            if (forests.empty())
+                throw std::runtime_error("GeneralizedIsolationForest::merge: At least one forest is required.");
+            const Parameters& firstParameters = forests[0]->_parameters;
+            unsigned int nextModelIndex = 0;
+            size_t nModels = 0;
+            std::uint64_t nObservations = 0;
+            for (const GeneralizedIsolationForest* forest : forests) {
+                const Parameters& parameters = forest->_parameters;
+                if (forest->_compiledForest.empty() || forest->_gtrBagging.getNumberOfObservations() == 0)
+                    throw std::runtime_error("GeneralizedIsolationForest::merge: Number of models is insufficient (maybe forgot to call `fit`?).");
+                if (parameters.k != firstParameters.k || parameters.kernelId != firstParameters.kernelId || parameters.sigma != firstParameters.sigma
+                    || parameters.kernelScaling.size() != firstParameters.kernelScaling.size() || parameters.kernelScaling != firstParameters.kernelScaling
+                    || parameters.sampleSize != firstParameters.sampleSize || parameters.approximationDelta != firstParameters.approximationDelta)
+                    throw std::runtime_error("GeneralizedIsolationForest::merge: The forests need to share k, the kernel, the kernel scaling, sigma, the sample size and the "
+                                             "approximation delta.");
+                if (forest->_compiledForest.getNumberOfDimensions() != forests[0]->_compiledForest.getNumberOfDimensions())
+                    throw std::runtime_error("GeneralizedIsolationForest::merge: The forests need to share the number of dimensions.");
+                nextModelIndex = std::max(nextModelIndex, forest->_gtrBagging.getNextModelIndex());
+                nModels += forest->_compiledForest.getNumberOfTrees();
+                nObservations += forest->_gtrBagging.getNumberOfObservations();
+            }
+
+            std::vector<GIFModel<T>> models;
+            models.reserve(nModels);
+            for (const GeneralizedIsolationForest* forest : forests) {
+                // The weights of the trees of a forest may differ (e.g. if it has been merged itself), hence they are scaled relative to their sum.
+                std::vector<GIFModel<T>> forestModels = forest->getModel();
+                double weightSum = 0;
+                for (const GIFModel<T>& model : forestModels)
+                    weightSum += model.treeWeight;
+                const double weightFactor = static_cast<double>(nModels) * forest->_gtrBagging.getNumberOfObservations() / (static_cast<double>(nObservations) * weightSum);
+                for (GIFModel<T>& model : forestModels) {
+                    model.treeWeight *= weightFactor;
+                    models.push_back(std::move(model));
+                }
+            }
+
+            Parameters parameters = firstParameters;
+            parameters.nModels = static_cast<unsigned int>(nModels);
+            auto merged = std::make_unique<GeneralizedIsolationForest>(parameters);
+            merged->_compiledForest = CompiledForest<T>(models);
+            merged->_gtrBagging.setModels(std::move(models));
+            merged->_gtrBagging.setNextModelIndex(nextModelIndex);
+            merged->_gtrBagging.setNumberOfObservations(nObservations);
+            return merged;
+        }
+
         /**
          * Destructor.
          */
         ~GeneralizedIsolationForest() override = default;
 
     private:
-        GIFExitConditionAverageKernelValue _exitCondition;
-        GeneralizedIsolationTree _gTree;
-        BaggingEnsemble<GIFModel, OutlierDetectionResult> _gtrBagging;
+        /**
+         * Recovers the models of a deserialized forest from its compiled representation, such that trees can be added or replaced.
+         */
+        void restoreModels() {
+            if (_gtrBagging.getActualNumberOfModels() == 0 && !_compiledForest.empty())
+                _gtrBagging.setModels(_compiledForest.getModels());
+        }
+
+        /**
+         * Serializes everything, which precedes the compiled forest, i.e. the header, the kernel name, the kernel scaling values and the padding.
+         */
+        std::vector<unsigned char> serializeHeader() const {
+            GeneralizedIsolationForestHeader header = {};
+            header.magic = magic;
+            header.version = formatVersion;
+            header.scalarSize = sizeof(T);
+            header.k = _parameters.k;
+            header.nModels = _parameters.nModels;
+            header.sampleSize = _parameters.sampleSize;
+            header.workerCount = _parameters.workerCount;
+            header.seed = _parameters.seed;
+            header.nextModelIndex = _gtrBagging.getNextModelIndex();
+            header.nObservations = _gtrBagging.getNumberOfObservations();
+            header.sigma = _parameters.sigma;
+            header.approximationDelta = _parameters.approximationDelta;
+            header.kernelIdOffset = sizeof(header);
+            header.kernelIdLength = _parameters.kernelId.size();
+            header.kernelScalingOffset = header.kernelIdOffset + header.kernelIdLength;
+            header.kernelScalingLength = _parameters.kernelScaling.size();
+            header.forestOffset = (header.kernelScalingOffset + header.kernelScalingLength * sizeof(T) + 63) / 64 * 64;
+            header.forestSize = _compiledForest.size();
+
+            std::vector<unsigned char> buffer(header.forestOffset, 0);
+            std::memcpy(buffer.data(), &header, sizeof(header));
+            std::memcpy(buffer.data() + header.kernelIdOffset, _parameters.kernelId.data(), header.kernelIdLength);
+            std::memcpy(buffer.data() + header.kernelScalingOffset, _parameters.kernelScaling.data(), header.kernelScalingLength * sizeof(T));
+            return buffer;
+        }
+
+        /**
+         * Creates the base learner, i.e. a GeneralizedIsolationTree, which is specialized for the requested kernel. The kernel name is resolved once here, such that tree
+         * induction calls the kernel directly.
+         * @param k The number of representatives to find for each node of the tree.
+         * @param kernelId Name of the kernel to use (possible values: rbf, matern-d1, matern-d3, matern-d5).
+         * @param kernelScaling Vector of scaling values for the kernel to be used.
+         * @param sigma Average kernel value, which should be exceeded for the exit condition to apply.
+         * @param delta Failure probability of the sampled exit condition (0 disables sampling).
+         * @param workerCount Number of parallel workers to consider.
+         * @param seed Seed to use for random number generation.
+         * @return As stated above.
+         */
+        static std::unique_ptr<GeneralizedIsolationTreeLearner<T>> makeTree(unsigned int k, const std::string& kernelId, const VectorX<T>& kernelScaling, T sigma, T delta,
+                                                                            unsigned int workerCount, int seed) {
+            if (kernelId == "rbf")
+                return makeTree(k, RBFKernel<T>(kernelScaling[0]), sigma, delta, workerCount, seed);
+            else if (kernelId == "matern-d1")
+                return makeTree(k, MaternKernel<T, 1>(kernelScaling), sigma, delta, workerCount, seed);
+            else if (kernelId == "matern-d3")
+                return makeTree(k, MaternKernel<T, 3>(kernelScaling), sigma, delta, workerCount, seed);
+            else if (kernelId == "matern-d5")
+                return makeTree(k, MaternKernel<T, 5>(kernelScaling), sigma, delta, workerCount, seed);
+            else
+                throw std::runtime_error("GeneralizedIsolationForest::makeTree: Unknown kernel supplied ('" + kernelId +
+                                         "'). Possible choices are: rbf, matern-d1, matern-d3, matern-d5.");
+        }
+
+        /**
+         * Creates a GeneralizedIsolationTree, whose exit condition is specialized for a given kernel type.
+         * @tparam KernelType The type of the kernel.
+         * @param k The number of representatives to find for each node of the tree.
+         * @param kernel The kernel to use.
+         * @param sigma Average kernel value, which should be exceeded for the exit condition to apply.
+         * @param delta Failure probability of the sampled exit condition (0 disables sampling).
+         * @param workerCount Number of parallel workers to consider.
+         * @param seed Seed to use for random number generation.
+         * @return As stated above.
+         */
+        template<typename KernelType>
+        static std::unique_ptr<GeneralizedIsolationTreeLearner<T>> makeTree(unsigned int k, KernelType kernel, T sigma, T delta, unsigned int workerCount, int seed) {
+            using ExitCondition = GIFExitConditionAverageKernelValue<T, KernelType>;
+            return std::make_unique<GeneralizedIsolationTree<T, ExitCondition>>(k, ExitCondition(std::move(kernel), sigma, delta), workerCount, seed);
+        }
+
+        Parameters _parameters;
+        unsigned int _workerCount;
+        std::unique_ptr<GeneralizedIsolationTreeLearner<T>> _gTree;
+        BaggingEnsemble<GIFModel<T>, OutlierDetectionResult<T>, T> _gtrBagging;
+        CompiledForest<T> _compiledForest;
+        std::deque<std::vector<T>> _window; // The leaf counts of the updates in the sliding window (see `update`), oldest first.
     };
+
+    template<typename T>
+    const std::uint64_t GeneralizedIsolationForest<T>::magic;
+
+    template<typename T>
+    const std::uint64_t GeneralizedIsolationForest<T>::formatVersion;
 }
 
 #endif // GENIF_GENERALIZEDISOLATIONFOREST_H
@@ -1,18 +1,47 @@
 #ifndef GENIF_GENERALIZEDISOLATIONTREE_H
 #define GENIF_GENERALIZEDISOLATIONTREE_H
 
+#include "DistanceEngine.h"
 #include "GIFExitCondition.h"
 #include "GIFModel.h"
+#include "Partitioning.h"
 #include "Tree.h"
+#include <algorithm>
 #include <chrono>
 #include <genif/Learner.h>
 #include <genif/OutlierDetectionResult.h>
-#include <nanoflann.hpp>
+#include <genif/Tools.h>
+#include <genif/random/SplitMix64.h>
+#include <numeric>
 #include <random>
 #include <set>
 
 namespace genif {
-    class GeneralizedIsolationTree : public Learner<GIFModel, OutlierDetectionResult> {
+    /**
+     * The interface of GeneralizedIsolationTree, which does not depend on the type of its exit condition.
+     * @tparam T The scalar type of the dataset (float or double).
+     */
+    template<typename T>
+    class GeneralizedIsolationTreeLearner : public Learner<GIFModel<T>, OutlierDetectionResult<T>, T> {
+    public:
+        /**
+         * Fits one model per threshold of the exit condition from a single tree induction (see GeneralizedIsolationTree::fitFamily).
+         * @param dataset The dataset, which holds the observations.
+         * @param rowIndices The indices of the rows, which should be used for fitting (rows may occur multiple times).
+         * @param sigmas The thresholds in ascending order.
+         * @return The models in the order of the thresholds.
+         */
+        virtual std::vector<GIFModel<T>> fitFamily(const RowMatrixXRef<T>& dataset, const std::vector<unsigned int>& rowIndices, const std::vector<T>& sigmas) = 0;
+    };
+
+    /**
+     * A single Generalized Isolation Tree, which summarizes a dataset by recursively clustering it around randomly chosen representatives.
+     * @tparam T The scalar type of the dataset (float or double).
+     * @tparam ExitCondition The type of the exit condition (e.g. GIFExitConditionAverageKernelValue), which controls, when tree induction is stopped. It is called directly
+     * for every node, hence its code is specialized for the tree.
+     */
+    template<typename T, typename ExitCondition>
+    class GeneralizedIsolationTree : public GeneralizedIsolationTreeLearner<T> {
     public:
         /**
          * Constructs an instance of GeneralizedIsolationTree.
@@ -21,8 +50,8 @@ namespace genif {
          * @param workerCount Number of workers to consider.
          * @param seed Seed to use for random number generation (-1 defaults to sysclock seed). Pass an integer for constant result across multiple runs.
          */
-        GeneralizedIsolationTree(unsigned int k, const GIFExitCondition& exitCondition, unsigned int workerCount, int seed = -1) :
-            _k(k), _workerCount(workerCount), _exitCondition(exitCondition), _seed(seed) {
+        GeneralizedIsolationTree(unsigned int k, ExitCondition exitCondition, unsigned int workerCount, int seed = -1) :
+            _k(k), _workerCount(workerCount), _seed(seed), _exitCondition(std::move(exitCondition)) {
             if (_k <= 1)
                 throw std::runtime_error("GeneralizedIsolationTree::GeneralizedIsolationTree: k needs to be at least two.");
             if (_workerCount < 1)
@@ -34,167 +63,172 @@ namespace genif {
          * @param dataset The dataset to use for fitting.
          * @return A reference to this object.
          */
-        Learner<GIFModel, OutlierDetectionResult>& fit(const MatrixX& dataset) override {
+        Learner<GIFModel<T>, OutlierDetectionResult<T>, T>& fit(const RowMatrixXRef<T>& dataset) override {
+            std::vector<unsigned int> rowIndices(dataset.rows());
+            std::iota(rowIndices.begin(), rowIndices.end(), 0);
+            return fit(dataset, rowIndices);
+        }
+
+        /**
+         * Fits the tree using a subset of the rows of a given dataset. The rows are read from the dataset directly, only the summary vectors of the leaves are copied into the
+         * model.
+         * @param dataset The dataset, which holds the observations.
+         * @param rowIndices The indices of the rows, which should be used for fitting (rows may occur multiple times).
+         * @return A reference to this object.
+         */
+        Learner<GIFModel<T>, OutlierDetectionResult<T>, T>& fit(const RowMatrixXRef<T>& dataset, const std::vector<unsigned int>& rowIndices) override {
             // Check, whether we have enough observations.
-            if (dataset.rows() < _k)
+            if (rowIndices.size() < _k)
                 throw std::runtime_error("GeneralizedIsolationTree::fit: The dataset should have at least k = " + std::to_string(_k) + " observations but has "
-                                         + std::to_string(dataset.rows()) + " observations.");
+                                         + std::to_string(rowIndices.size()) + " observations.");
 
-            // Assign the tree to this object.
-            Tree* treeRoot = findTree(dataset);
-
-            // Find leafs.
-            std::vector<unsigned int> leafVectorIndices;
-            std::function<void(const Tree&)> findRepresentatives = [&findRepresentatives, &leafVectorIndices](const Tree& node) {
-                if (!node.nodes.empty()) {
-                    for (auto& childNode : node.nodes)
-                        findRepresentatives(*childNode);
-                } else
-                    leafVectorIndices.push_back(node.representativeIndex);
-            };
-            findRepresentatives(*treeRoot);
+            // Induce a tree and find its leafs. The tree is not needed anymore afterwards.
+            _model = buildModel(dataset, rowIndices, findTree(dataset, rowIndices).getLeafRepresentatives());
+            return *this;
+        }
 
-            // Delete the tree since we do not need it anymore.
-            delete treeRoot;
+        /**
+         * Fits one model per threshold (i.e. sigma value of the exit condition) from a single tree induction.
+         *
+         * The exit condition only applies later for larger thresholds, and the split of a node does not depend on the threshold. Hence, the tree of a larger threshold
+         * refines the tree of a smaller one. The tree is induced once for the largest threshold, whereas every node records, for how many thresholds its exact average kernel
+         * value suffices to stop (see TreeNode::exitRank). The tree of every threshold is then cut out of the whole tree. The resulting models are identical to the ones of
+         * separate fits with the same seed and an exit condition, which is evaluated exactly.
+         *
+         * @param dataset The dataset, which holds the observations.
+         * @param rowIndices The indices of the rows, which should be used for fitting (rows may occur multiple times).
+         * @param sigmas The thresholds in ascending order. The threshold of the exit condition of this tree is ignored.
+         * @return The models in the order of the thresholds.
+         */
+        std::vector<GIFModel<T>> fitFamily(const RowMatrixXRef<T>& dataset, const std::vector<unsigned int>& rowIndices, const std::vector<T>& sigmas) override {
+            if (rowIndices.size() < _k)
+                throw std::runtime_error("GeneralizedIsolationTree::fitFamily: The dataset should have at least k = " + std::to_string(_k) + " observations but has "
+                                         + std::to_string(rowIndices.size()) + " observations.");
+            if (sigmas.empty() || !std::is_sorted(sigmas.begin(), sigmas.end()))
+                throw std::runtime_error("GeneralizedIsolationTree::fitFamily: sigmas need to be non-empty and sorted in ascending order.");
+
+            const Tree<T> tree = findTree(dataset, rowIndices, sigmas);
+            std::vector<GIFModel<T>> models;
+            for (unsigned int i = 0; i < sigmas.size(); i++)
+                models.push_back(buildModel(dataset, rowIndices, tree.getLeafRepresentatives(i)));
+            return models;
+        }
 
+        /**
+         * Creates a model from the leaves of a tree, whereas the probability of every region is estimated from the fraction of the given rows, which fall into it.
+         * @param dataset The dataset, which holds the observations.
+         * @param rowIndices The indices of the rows, which the tree has been induced from.
+         * @param leafVectorIndices The dataset row indices of the leaf representatives.
+         * @return As stated above.
+         */
+        GIFModel<T> buildModel(const RowMatrixXRef<T>& dataset, const std::vector<unsigned int>& rowIndices, const std::vector<unsigned int>& leafVectorIndices) const {
             // Create a GIFModel instance.
-            GIFModel resultModel;
+            GIFModel<T> resultModel;
 
             // Build matrix from leaf nodes.
-            resultModel.dataMatrix = std::make_shared<MatrixX>(leafVectorIndices.size(), dataset.cols());
+            resultModel.dataMatrix = std::make_shared<MatrixX<T>>(leafVectorIndices.size(), dataset.cols());
             for (unsigned int i = 0; i < leafVectorIndices.size(); i++)
                 resultModel.dataMatrix->row(i) = dataset.row(leafVectorIndices[i]);
 
-            // Build KDTree on summary.
-            auto kdTree = std::make_shared<nanoflann::KDTreeEigenMatrixAdaptor<MatrixX>>(resultModel.dataMatrix->cols(), std::cref(*resultModel.dataMatrix), 10);
-            kdTree->index->buildIndex();
-
-            // Iterate through the dataset and determine for each vector the nearest vectors in the summary.
-            resultModel.countsPerRegion = std::vector<unsigned long>(resultModel.dataMatrix->rows(), 0);
-#pragma omp parallel for num_threads(_workerCount)
-            for (unsigned long i = 0; i < dataset.rows(); i++) {
-                // Make KNN query for nearest summary vector.
-                size_t nearestSummaryIndex;
-                data_t sqDistance;
-                nanoflann::KNNResultSet<data_t> resultSet(1);
-                resultSet.init(&nearestSummaryIndex, &sqDistance);
-
-                VectorX datasetVector = dataset.row(i);
-                kdTree->index->findNeighbors(resultSet, datasetVector.data(), nanoflann::SearchParams(10));
-
-                // Increase count for nearest summary point.
-#pragma omp critical
-                resultModel.countsPerRegion[nearestSummaryIndex] += 1;
-            }
+            // Build the search structure on the summary.
+            resultModel.leafIndex = std::make_shared<LeafIndex<T>>(*resultModel.dataMatrix);
 
-            // Calculate estimated probabilities for every region.
-            resultModel.probabilitiesPerRegion = std::vector<data_t>(resultModel.dataMatrix->rows(), 0.0);
-            for (unsigned long i = 0; i < resultModel.dataMatrix->rows(); i++)
-                resultModel.probabilitiesPerRegion[i] = static_cast<data_t>(resultModel.countsPerRegion[i]) / static_cast<data_t>(dataset.size());
+            // Determine for each of the selected rows the nearest vector in the summary.
+            const unsigned int workerCount = Tools::availableWorkerCount(_workerCount);
+            std::vector<unsigned int> nearestSummaryIndices(rowIndices.size());
+            resultModel.findRegions(dataset, rowIndices.data(), rowIndices.size(), nearestSummaryIndices.data(), workerCount);
 
-            // Assign properties.
-            resultModel.dataKDTree = kdTree;
-            _model = resultModel;
+            // Count the vectors per summary point.
+            resultModel.countsPerRegion = Partitioning::histogram(nearestSummaryIndices.data(), nearestSummaryIndices.size(), resultModel.dataMatrix->rows(), workerCount);
 
-            return *this;
+            // Calculate estimated probabilities for every region.
+            const auto nValues = static_cast<T>(rowIndices.size() * dataset.cols());
+            resultModel.probabilitiesPerRegion = std::vector<T>(resultModel.dataMatrix->rows(), 0.0);
+            resultModel.weightsPerRegion = std::vector<T>(resultModel.dataMatrix->rows(), 0.0);
+            for (unsigned long i = 0; i < resultModel.dataMatrix->rows(); i++) {
+                resultModel.probabilitiesPerRegion[i] = static_cast<T>(resultModel.countsPerRegion[i]) / nValues;
+                resultModel.weightsPerRegion[i] = static_cast<T>(resultModel.countsPerRegion[i]);
+            }
+
+            return resultModel;
         }
 
         /**
          * Finds a tree using a given dataset.
+         *
+         * Large nodes near the root are split one after another, whereas each split is computed by all workers (data-parallel). Once nodes become smaller, their subtrees are
+         * grown as independent OpenMP tasks (task-parallel). Every node draws its representatives from its own random stream, which is derived from the stream of its parent.
+         * Hence, the induced tree does not depend on the order, in which the nodes are processed.
+         *
          * @param dataset The dataset to create the tree from.
-         * @return A raw pointer to the induced tree.
+         * @param rowIndices The indices of the dataset rows, which should be used to create the tree (rows may occur multiple times).
+         * @param familySigmas If given, the tree is induced for a family of thresholds in ascending order instead of the threshold of the exit condition (see `fitFamily`).
+         * @return The induced tree.
          */
-        Tree* findTree(const MatrixX& dataset) {
-            // Create PRNG.
-            std::default_random_engine generator(_seed >= 0 ? _seed : std::chrono::system_clock::now().time_since_epoch().count());
-
-            // Initialize a tree.
-            Tree* treeRoot = new Tree(dataset);
-            for (unsigned int i = 0; i < dataset.rows(); i++)
-                treeRoot->vectorIndices.emplace_back(i);
+        Tree<T> findTree(const RowMatrixXRef<T>& dataset, const std::vector<unsigned int>& rowIndices, const std::vector<T>& familySigmas = {}) {
+            // Initialize a tree, whose root holds all vectors.
+            const auto nVectors = static_cast<unsigned int>(rowIndices.size());
+            Tree<T> tree(dataset, rowIndices);
+            tree.vectorIndices.resize(nVectors);
+            std::iota(tree.vectorIndices.begin(), tree.vectorIndices.end(), 0);
+            tree.representativeSqDistances.resize(nVectors);
 
             // Choose a (somewhat) random representative.
-            treeRoot->representativeIndex = 0;
-
-            // Create a worker data structure.
-            std::vector<std::pair<unsigned int, Tree*>> treeTasks;
-            treeTasks.emplace_back(0, treeRoot);
-
-            while (!treeTasks.empty()) {
-                // Choose a root node to work on.
-                auto task = treeTasks.back();
-                treeTasks.pop_back();
+            TreeNode rootNode;
+            rootNode.end = nVectors;
+            rootNode.representativeIndex = 0;
+            rootNode.seed = _seed >= 0 ? _seed : std::chrono::system_clock::now().time_since_epoch().count();
+            tree.nodes.push_back(rootNode);
+
+            // Set up the state, which is shared by all nodes. If we are called from within a parallel region (e.g. by an ensemble), the workers of the enclosing team are
+            // used by spawning tasks instead of opening nested parallel regions.
+            InductionState state(tree, DistanceEngine<T>::selectMethod(_k));
+            state.nested = Tools::isInParallelRegion();
+            state.familySigmas = familySigmas;
+
+            // The root is the only node, for which the distances to the representative are not known from a previous clustering step.
+            state.distanceEngine.assign(tree.vectorIndices.data(), nVectors, {rootNode.representativeIndex}, state.labels.data(), tree.representativeSqDistances.data(),
+                                        state.nested ? 1 : _workerCount);
+
+            // Split large nodes with all workers, until the remaining nodes are small enough to be processed as independent tasks.
+            std::vector<TreeTask> dataParallelTasks;
+            std::vector<TreeTask> taskParallelTasks;
+            (isDataParallel(state, rootNode) ? dataParallelTasks : taskParallelTasks).emplace_back(0, rootNode);
+            while (!dataParallelTasks.empty()) {
+                const TreeTask task = dataParallelTasks.back();
+                dataParallelTasks.pop_back();
+                for (auto& childTask : splitNode(&state, task, _workerCount))
+                    (isDataParallel(state, childTask.second) ? dataParallelTasks : taskParallelTasks).push_back(childTask);
+            }
 
-                unsigned int treeHeight = task.first;
-                Tree* root = task.second;
-
-                // Check, whether the exit condition already applies.
-                bool shouldExit = _exitCondition.shouldExitRecursion(*root);
-                if (!shouldExit) {
-                    // Randomly sample representatives from node.
-                    std::set<unsigned int> repIndices;
-                    std::uniform_int_distribution<unsigned int> distribution(0, root->vectorIndices.size() - 1);
-                    for (unsigned int j = 0; j < _k; j++) {
-                        unsigned int nextIndex = root->vectorIndices[distribution(generator)];
-                        while (repIndices.find(nextIndex) != repIndices.end())
-                            nextIndex = root->vectorIndices[distribution(generator)];
-                        repIndices.insert(nextIndex);
-                    }
-                    std::vector<unsigned int> clusterRepIndices(repIndices.begin(), repIndices.end());
-
-                    // Generate clustering.
-                    std::vector<std::vector<unsigned int>> clusters(clusterRepIndices.size());
-#pragma omp parallel for num_threads(_workerCount)
-                    for (unsigned int i = 0; i < root->vectorIndices.size(); i++) {
-                        unsigned int fvIndex = root->vectorIndices[i];
-                        unsigned int nearestIdx;
-                        data_t nearestDist = std::numeric_limits<data_t>::max();
-
-                        for (unsigned int j = 0; j < clusterRepIndices.size(); j++) {
-                            data_t repDist = (dataset.row(fvIndex) - dataset.row(clusterRepIndices.at(j))).squaredNorm();
-                            if (repDist < nearestDist) {
-                                nearestDist = repDist;
-                                nearestIdx = j;
-                            }
-                        }
-
-                        // Put vector in bucket.
-#pragma omp critical
-                        clusters[nearestIdx].push_back(fvIndex);
-                    }
-
-                    // Every partition becomes a new node.
-                    // Check, whether we have found exactly K clusters.
-                    if (clusters.size() == _k) {
-                        // Iterate all clusters and create new nodes from it.
-                        for (unsigned int i = 0; i < clusters.size(); i++) {
-                            // Create a new node.
-                            Tree* node = new Tree(dataset);
-                            node->vectorIndices = clusters[i];
-                            node->representativeIndex = clusterRepIndices[i];
-                            node->parent = root;
-
-                            // Assign node to root.
-                            root->nodes.push_back(node);
-
-                            // If we have more than k observations in that node, we may create new tasks, which then are subject to further partitioning.
-                            if (node->vectorIndices.size() > _k)
-                                treeTasks.push_back(std::make_pair<unsigned int, Tree*>(treeHeight + 1, &*node));
-                        }
-                    } else
-                        throw std::runtime_error("GeneralizedIsolationTree::fit: Clusterer did not return k = " + std::to_string(_k) + " clusters from "
-                                                 + std::to_string(root->vectorIndices.size()) + " observations.");
+            // Grow the remaining subtrees.
+            InductionState* statePtr = &state;
+            if (_workerCount > 1 && state.nested) {
+#pragma omp taskgroup
+                for (auto& task : taskParallelTasks) {
+#pragma omp task firstprivate(statePtr, task)
+                    growSubtree(statePtr, task);
                 }
+            } else if (_workerCount > 1) {
+#pragma omp parallel num_threads(_workerCount)
+#pragma omp single
+                for (auto& task : taskParallelTasks) {
+#pragma omp task firstprivate(statePtr, task)
+                    growSubtree(statePtr, task);
+                }
+            } else {
+                for (auto& task : taskParallelTasks)
+                    growSubtree(&state, task);
             }
 
-            return treeRoot;
+            return tree;
         }
 
         /**
          * Returns a previously fitted model.
          * @return As stated above.
          */
-        GIFModel getModel() const override {
+        GIFModel<T> getModel() const override {
             return _model;
         }
 
@@ -203,7 +237,7 @@ namespace genif {
          * @param dataset The dataset to inspect for outliers.
          * @return An instance of OutlierDetectionResult which contains the probabilities for individual observations to be inliers.
          */
-        OutlierDetectionResult predict(const MatrixX& dataset) const override {
+        OutlierDetectionResult<T> predict(const RowMatrixXRef<T>& dataset) const override {
             return predict(dataset, _model);
         }
 
@@ -213,47 +247,183 @@ namespace genif {
          * @param model The model to use for prediction.
          * @return An instance of OutlierDetectionResult which contains the probabilities for individual observations to be inliers.
          */
-        OutlierDetectionResult predict(const MatrixX& dataset, const GIFModel& model) const override {
+        OutlierDetectionResult<T> predict(const RowMatrixXRef<T>& dataset, const GIFModel<T>& model) const override {
             if (!model.probabilitiesPerRegion.empty()) {
                 // Create a result model.
-                OutlierDetectionResult result;
-                result.probabilities = VectorX::Zero(dataset.rows());
-
-                // Make the anomaly decision for every data point.
-#pragma omp parallel for num_threads(_workerCount)
-                for (unsigned long i = 0; i < dataset.rows(); i++) {
-                    // Make KNN query for nearest summary vector.
-                    size_t nearestSummaryIndex;
-                    data_t sqDistance;
-                    nanoflann::KNNResultSet<data_t> resultSet(1);
-                    resultSet.init(&nearestSummaryIndex, &sqDistance);
-
-                    VectorX datasetVector = dataset.row(i);
-                    model.dataKDTree->index->findNeighbors(resultSet, datasetVector.data(), nanoflann::SearchParams(10));
-
-                    // Assign probability values.
-                    result.probabilities[i] = model.probabilitiesPerRegion[nearestSummaryIndex];
-                }
+                OutlierDetectionResult<T> result;
+                result.probabilities = VectorX<T>::Zero(dataset.rows());
+
+                // Find the nearest summary vector for every data point and assign probability values.
+                std::vector<unsigned int> regions(dataset.rows());
+                model.findRegions(dataset, nullptr, regions.size(), regions.data(), Tools::availableWorkerCount(_workerCount));
+                for (unsigned long i = 0; i < dataset.rows(); i++)
+                    result.probabilities[i] = model.probabilitiesPerRegion[regions[i]];
 
                 return result;
             } else
                 throw std::runtime_error("GeneralizedIsolationTree:predict: No model has been learnt yet. Please call `fit` or `fitPredict` first.");
         }
 
+        /**
+         * Sets the number of workers, which are used to fit the tree and to make predictions.
+         * @param workerCount Number of workers to consider.
+         */
+        void setWorkerCount(unsigned int workerCount) override {
+            if (workerCount < 1)
+                throw std::runtime_error("GeneralizedIsolationTree::setWorkerCount: workerCount needs to be at least one.");
+            _workerCount = workerCount;
+        }
+
+        /**
+         * Sets the seed, which is used to derive the random streams of the tree nodes.
+         * @param seed Seed to use for random number generation (-1 defaults to sysclock seed).
+         */
+        void setSeed(int seed) override {
+            _seed = seed;
+        }
+
         /**
          * Takes a copy of this object.
          * @return An unique_ptr pointing to a copy of this instance.
          */
-        std::unique_ptr<Learner<GIFModel, OutlierDetectionResult>> copy() const override {
+        std::unique_ptr<Learner<GIFModel<T>, OutlierDetectionResult<T>, T>> copy() const override {
             return std::make_unique<GeneralizedIsolationTree>(_k, _exitCondition, _workerCount, _seed);
         }
 
     private:
+        /**
+         * A node, which is subject to further partitioning, along with its position in the node pool.
+         */
+        typedef std::pair<unsigned int, TreeNode> TreeTask;
+
+        /**
+         * Holds the state, which is shared by all nodes during tree induction. Since the nodes of a tree level own disjoint ranges of the index array, each node uses the same
+         * range of the scratch arrays and nodes may therefore be processed concurrently.
+         */
+        struct InductionState {
+            Tree<T>& tree;
+            DistanceEngine<T> distanceEngine;
+            std::vector<unsigned int> labels;
+            std::vector<unsigned int> scratchIndices;
+            std::vector<T> scratchSqDistances;
+            std::vector<T> familySigmas; // The thresholds of a family fit in ascending order (empty for ordinary fits).
+            bool nested = false;
+
+            InductionState(Tree<T>& tree, AssignmentMethod assignmentMethod) :
+                tree(tree), distanceEngine(tree.dataset, tree.rowIndices, assignmentMethod), labels(tree.vectorIndices.size()), scratchIndices(tree.vectorIndices.size()),
+                scratchSqDistances(tree.vectorIndices.size()) {
+            }
+        };
+
+        /**
+         * Returns, whether a node is large enough to have its split computed by all workers.
+         */
+        bool isDataParallel(const InductionState& state, const TreeNode& node) const {
+            return _workerCount > 1 && !state.nested && node.size() >= _dataParallelNodeSize;
+        }
+
+        /**
+         * Splits a node into k children, unless the exit condition applies.
+         * @param state The shared induction state.
+         * @param task The node to split.
+         * @param workerCount Number of workers to compute the split with.
+         * @return The children, which are subject to further partitioning.
+         */
+        std::vector<TreeTask> splitNode(InductionState* state, const TreeTask& task, unsigned int workerCount) const {
+            Tree<T>& tree = state->tree;
+            const TreeNode& root = task.second;
+            std::vector<TreeTask> childTasks;
+
+            // Check, whether the exit condition already applies. Family fits record the number of thresholds, which the average kernel value reaches, and only stop once
+            // all of them are reached.
+            if (state->familySigmas.empty()) {
+                if (_exitCondition.shouldExitRecursion(tree, root))
+                    return childTasks;
+            } else {
+                const T averageKernelValue = _exitCondition.averageKernelValue(tree, root);
+                const auto exitRank =
+                    static_cast<unsigned int>(std::upper_bound(state->familySigmas.begin(), state->familySigmas.end(), averageKernelValue) - state->familySigmas.begin());
+#pragma omp critical(genif_tree_nodes)
+                tree.nodes[task.first].exitRank = exitRank;
+                if (exitRank == state->familySigmas.size())
+                    return childTasks;
+            }
+
+            // Randomly sample k distinct positions of the node and use the vectors found there as representatives.
+            SplitMix64 generator(root.seed);
+            std::set<unsigned int> repPositions;
+            std::uniform_int_distribution<unsigned int> distribution(root.begin, root.end - 1);
+            while (repPositions.size() < _k)
+                repPositions.insert(distribution(generator));
+            std::vector<unsigned int> clusterRepIndices;
+            for (auto position : repPositions)
+                clusterRepIndices.push_back(tree.vectorIndices[position]);
+
+            // Generate clustering.
+            state->distanceEngine.assign(&tree.vectorIndices[root.begin], root.size(), clusterRepIndices, &state->labels[root.begin], &state->scratchSqDistances[root.begin],
+                                         workerCount);
+
+            // Group the node's range by cluster in place and keep the distances to the new representatives for the exit condition.
+            const std::vector<size_t> clusterOffsets =
+                Partitioning::partition(&state->labels[root.begin], root.size(), _k, workerCount, &tree.vectorIndices[root.begin], &state->scratchSqDistances[root.begin],
+                                        &state->scratchIndices[root.begin], &tree.representativeSqDistances[root.begin]);
+            std::copy(state->scratchIndices.begin() + root.begin, state->scratchIndices.begin() + root.end, tree.vectorIndices.begin() + root.begin);
+
+            // Every partition becomes a new node.
+            std::vector<TreeNode> children(_k);
+            for (unsigned int i = 0; i < _k; i++) {
+                children[i].begin = root.begin + clusterOffsets[i];
+                children[i].end = root.begin + clusterOffsets[i + 1];
+                children[i].representativeIndex = clusterRepIndices[i];
+                children[i].depth = root.depth + 1;
+                children[i].seed = SplitMix64::split(root.seed, i);
+            }
+
+            // Append the children to the node pool, which may be shared with other tasks.
+            unsigned int firstChild;
+#pragma omp critical(genif_tree_nodes)
+            {
+                firstChild = tree.nodes.size();
+                tree.nodes[task.first].firstChild = firstChild;
+                tree.nodes[task.first].childCount = _k;
+                tree.nodes.insert(tree.nodes.end(), children.begin(), children.end());
+            }
+
+            // If we have more than k observations in a node, we may create new tasks, which then are subject to further partitioning.
+            for (unsigned int i = 0; i < _k; i++)
+                if (children[i].size() > _k)
+                    childTasks.emplace_back(firstChild + i, children[i]);
+            return childTasks;
+        }
+
+        /**
+         * Grows the subtree below a node sequentially. Large children are spawned as separate OpenMP tasks, if called from within a parallel region.
+         * @param state The shared induction state.
+         * @param task The root node of the subtree.
+         */
+        void growSubtree(InductionState* state, const TreeTask& task) const {
+            std::vector<TreeTask> treeTasks = {task};
+            while (!treeTasks.empty()) {
+                const TreeTask nextTask = treeTasks.back();
+                treeTasks.pop_back();
+                for (auto& childTask : splitNode(state, nextTask, 1)) {
+                    if (_workerCount > 1 && childTask.second.size() >= _taskNodeSize) {
+#pragma omp task firstprivate(state, childTask)
+                        growSubtree(state, childTask);
+                    } else
+                        treeTasks.push_back(childTask);
+                }
+            }
+        }
+
         unsigned int _k = 10;
         unsigned int _workerCount = 1;
         int _seed;
-        const GIFExitCondition& _exitCondition;
-        GIFModel _model;
+        ExitCondition _exitCondition;
+        GIFModel<T> _model;
+        unsigned int _dataParallelNodeSize = 16384; // Nodes of at least this size are split by all workers.
+        unsigned int _taskNodeSize = 256; // Nodes of at least this size are grown as separate tasks.
+
     };
 }
 
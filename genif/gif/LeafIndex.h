@@ -0,0 +1,382 @@
+#ifndef GENIF_LEAFINDEX_H
+#define GENIF_LEAFINDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <genif/io/DataTypeHandling.h>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace genif {
+    /**
+     * The strategies for finding the nearest leaf vector of a model.
+     */
+    enum class LeafSearchMethod : std::uint32_t {
+        BruteForce = 0, // Scans all leaves, whereas blocks of queries are compared against tiles of leaves, which stay in cache.
+        SearchTree = 1 // Descends a k-d tree over the leaves.
+    };
+
+    /**
+     * A non-owning view of the leaf vectors of a model and of the search structure over them. The view is shared by LeafIndex and CompiledForest, so that a vector is
+     * assigned to the same region, regardless of whether a GIFModel or a compiled forest is queried.
+     *
+     * Both search methods compute exact squared euclidean distances and resolve ties in favor of the lowest region index. Hence, they always find the same region.
+     *
+     * @tparam T The scalar type of the leaf vectors (float or double).
+     */
+    template<typename T>
+    struct LeafSearch {
+        LeafSearchMethod method; // The search method.
+        std::uint64_t nLeaves; // The number of leaves.
+        std::uint64_t nDimensions; // The number of dimensions of the leaf vectors.
+        std::uint64_t stride; // The number of scalar values between two consecutive leaf vectors.
+        const T* leafValues; // Leaf vectors (nLeaves x stride values, row-major, in search order).
+        const std::uint32_t* regions; // Region indices of the leaves (nLeaves values, in search order).
+        const T* splitValues; // Split values of the search tree nodes.
+        const std::int32_t* splitDimensions; // Split dimensions of the search tree nodes (-1 for buckets).
+        const std::uint32_t* first; // Left children of inner nodes or first leaves of buckets.
+        const std::uint32_t* second; // Right children of inner nodes or one past the last leaves of buckets.
+
+        /**
+         * Finds the position of the nearest leaf (in search order) for a given vector.
+         * @param vector Pointer to the vector (`nDimensions` contiguous entries).
+         * @return As stated above.
+         */
+        size_t findLeaf(const T* vector) const {
+            size_t nearestLeaf = 0;
+            T nearestDist = std::numeric_limits<T>::max();
+            if (method == LeafSearchMethod::BruteForce) {
+                for (std::uint64_t i = 0; i < nLeaves; i++)
+                    updateNearest(i, squaredDistance(vector, leafValues + i * stride), nearestLeaf, nearestDist);
+                return nearestLeaf;
+            }
+
+            // Depth-first search, which always descends into the nearer child first. The stack holds nodes along with a lower bound of their distance.
+            std::pair<std::uint32_t, T> stack[128];
+            unsigned int stackSize = 0;
+            stack[stackSize++] = {0, 0.0};
+            while (stackSize > 0) {
+                const auto entry = stack[--stackSize];
+                if (entry.second > nearestDist)
+                    continue;
+
+                const std::uint32_t node = entry.first;
+                if (splitDimensions[node] < 0) {
+                    for (std::uint32_t i = first[node]; i < second[node]; i++)
+                        updateNearest(i, squaredDistance(vector, leafValues + i * stride), nearestLeaf, nearestDist);
+                } else {
+                    const T diff = vector[splitDimensions[node]] - splitValues[node];
+                    const std::uint32_t nearChild = diff < 0 ? first[node] : second[node];
+                    const std::uint32_t farChild = diff < 0 ? second[node] : first[node];
+                    stack[stackSize++] = {farChild, std::max(entry.second, diff * diff)};
+                    stack[stackSize++] = {nearChild, entry.second};
+                }
+            }
+
+            return nearestLeaf;
+        }
+
+        /**
+         * Finds the positions of the nearest leaves (in search order) for a block of vectors. The brute force search compares the whole block against one tile of leaves at
+         * a time, such that every leaf is loaded once per block instead of once per vector.
+         * @param vectors Pointer to the vectors (`nVectors` x `nDimensions` values, row-major).
+         * @param nVectors The number of vectors.
+         * @param leaves Output array of size `nVectors`, which receives the positions of the nearest leaves.
+         * @param sqDistances Output array of size `nVectors`, which receives the squared distances to the nearest leaves.
+         */
+        void findLeaves(const T* vectors, size_t nVectors, unsigned int* leaves, T* sqDistances) const {
+            if (method != LeafSearchMethod::BruteForce) {
+                for (size_t i = 0; i < nVectors; i++) {
+                    leaves[i] = static_cast<unsigned int>(findLeaf(vectors + i * nDimensions));
+                    sqDistances[i] = squaredDistance(vectors + i * nDimensions, leafValues + leaves[i] * stride);
+                }
+                return;
+            }
+
+            std::fill(leaves, leaves + nVectors, 0);
+            std::fill(sqDistances, sqDistances + nVectors, std::numeric_limits<T>::max());
+            for (std::uint64_t tileBegin = 0; tileBegin < nLeaves; tileBegin += _leafTileSize) {
+                const std::uint64_t tileEnd = std::min(tileBegin + _leafTileSize, nLeaves);
+                for (size_t i = 0; i < nVectors; i++) {
+                    const T* vector = vectors + i * nDimensions;
+                    size_t nearestLeaf = leaves[i];
+                    T nearestDist = sqDistances[i];
+                    for (std::uint64_t j = tileBegin; j < tileEnd; j++)
+                        updateNearest(j, squaredDistance(vector, leafValues + j * stride), nearestLeaf, nearestDist);
+                    leaves[i] = static_cast<unsigned int>(nearestLeaf);
+                    sqDistances[i] = nearestDist;
+                }
+            }
+        }
+
+    private:
+        static const std::uint64_t _leafTileSize = 64;
+
+        /**
+         * Computes the squared euclidean distance between a vector and a leaf vector.
+         */
+        T squaredDistance(const T* vector, const T* leaf) const {
+            T dist = 0.0;
+#pragma omp simd reduction(+ : dist)
+            for (std::uint64_t j = 0; j < nDimensions; j++) {
+                const T diff = vector[j] - leaf[j];
+                dist += diff * diff;
+            }
+            return dist;
+        }
+
+        /**
+         * Replaces the nearest leaf by leaf `i`, if it is nearer or equally near but belongs to a lower region.
+         */
+        void updateNearest(size_t i, T dist, size_t& nearestLeaf, T& nearestDist) const {
+            if (dist < nearestDist || (dist == nearestDist && regions[i] < regions[nearestLeaf])) {
+                nearestDist = dist;
+                nearestLeaf = i;
+            }
+        }
+    };
+
+    /**
+     * Owns the leaf vectors of a model together with the structure, which is used to find the region of a vector, i.e. the index of its nearest leaf vector.
+     *
+     * Summaries mostly consist of a few hundred leaves, for which a k-d tree hardly prunes anything in higher dimensions. Therefore, the search method is chosen from the
+     * number of leaves and their dimensionality: a k-d tree is only built if there are considerably more leaves than the tree has cells to prune, otherwise the leaves are
+     * scanned by brute force.
+     *
+     * @tparam T The scalar type of the leaf vectors (float or double).
+     */
+    template<typename T>
+    class LeafIndex {
+    public:
+        /**
+         * Constructs an empty LeafIndex.
+         */
+        LeafIndex() = default;
+
+        /**
+         * Constructs a LeafIndex over given leaf vectors and chooses the search method with `selectMethod`.
+         * @param leaves The leaf vectors (one per row), whereas the row index is the region index.
+         */
+        explicit LeafIndex(const MatrixX<T>& leaves) : LeafIndex(leaves, selectMethod(leaves.rows(), leaves.cols())) {
+        }
+
+        /**
+         * Constructs a LeafIndex over given leaf vectors using a given search method.
+         * @param leaves The leaf vectors (one per row), whereas the row index is the region index.
+         * @param method The search method to use.
+         */
+        LeafIndex(const MatrixX<T>& leaves, LeafSearchMethod method) :
+            _method(method), _nLeaves(leaves.rows()), _nDimensions(leaves.cols()), _stride(paddedStride(leaves.cols())) {
+            if (leaves.rows() < 1)
+                throw std::runtime_error("LeafIndex::LeafIndex: At least one leaf is required.");
+
+            // Determine the order of the leaves. The search tree reorders them, such that the leaves of a bucket are adjacent.
+            std::vector<unsigned int> permutation(leaves.rows());
+            std::iota(permutation.begin(), permutation.end(), 0);
+            if (_method == LeafSearchMethod::SearchTree)
+                buildSearchTree(leaves, permutation, 0, static_cast<unsigned int>(leaves.rows()));
+
+            _leafValues.assign(_nLeaves * _stride, 0.0);
+            _regions.resize(_nLeaves);
+            for (std::uint64_t i = 0; i < _nLeaves; i++) {
+                for (std::uint64_t j = 0; j < _nDimensions; j++)
+                    _leafValues[i * _stride + j] = leaves(permutation[i], j);
+                _regions[i] = permutation[i];
+            }
+        }
+
+        /**
+         * Constructs a LeafIndex by copying the leaves and the search structure of a view (e.g. of a compiled forest), i.e. without rebuilding the search structure.
+         * @param search The view to copy.
+         * @param nNodes The number of search tree nodes of the view (zero for brute force search).
+         */
+        LeafIndex(const LeafSearch<T>& search, std::uint64_t nNodes) :
+            _method(search.method), _nLeaves(search.nLeaves), _nDimensions(search.nDimensions), _stride(search.stride),
+            _leafValues(search.leafValues, search.leafValues + search.nLeaves * search.stride), _regions(search.regions, search.regions + search.nLeaves),
+            _splitValues(search.splitValues, search.splitValues + nNodes), _splitDimensions(search.splitDimensions, search.splitDimensions + nNodes),
+            _first(search.first, search.first + nNodes), _second(search.second, search.second + nNodes) {
+            if (_nLeaves < 1)
+                throw std::runtime_error("LeafIndex::LeafIndex: At least one leaf is required.");
+        }
+
+        /**
+         * Chooses the search method for a given number of leaves and dimensions. A k-d tree with buckets of a few leaves only pays off, if there are several leaves per cell
+         * of a grid with two cells per dimension, which never holds for 20 or more dimensions in practice.
+         * @param nLeaves The number of leaves.
+         * @param nDimensions The number of dimensions of the leaf vectors.
+         * @return As stated above.
+         */
+        static LeafSearchMethod selectMethod(std::uint64_t nLeaves, std::uint64_t nDimensions) {
+            if (nDimensions < 20 && nLeaves >= _minSearchTreeLeaves && nLeaves >= (std::uint64_t(4) << nDimensions))
+                return LeafSearchMethod::SearchTree;
+            return LeafSearchMethod::BruteForce;
+        }
+
+        /**
+         * Returns the number of scalar values between two consecutive leaf vectors, such that every leaf vector starts at a multiple of 64 bytes.
+         * @param nDimensions The number of dimensions of the leaf vectors.
+         * @return As stated above.
+         */
+        static std::uint64_t paddedStride(std::uint64_t nDimensions) {
+            const std::uint64_t valuesPerLine = 64 / sizeof(T);
+            return (nDimensions + valuesPerLine - 1) / valuesPerLine * valuesPerLine;
+        }
+
+        /**
+         * Returns a view, which can be used to search the leaves. The view is invalidated, if this object is modified or destroyed.
+         * @return As stated above.
+         */
+        LeafSearch<T> getSearch() const {
+            return {_method, _nLeaves, _nDimensions, _stride, _leafValues.data(), _regions.data(), _splitValues.data(), _splitDimensions.data(), _first.data(), _second.data()};
+        }
+
+        /**
+         * Finds the region, which a vector falls into, i.e. the index of the nearest leaf vector. Ties are resolved in favor of the lowest region index.
+         * @param vector Pointer to the vector (`getNumberOfDimensions()` contiguous entries).
+         * @return As stated above.
+         */
+        size_t findRegion(const T* vector) const {
+            return _regions[getSearch().findLeaf(vector)];
+        }
+
+        /**
+         * Finds the regions for a set of dataset rows. Rows are processed in contiguous blocks, which are searched at once.
+         * @param dataset The dataset, which holds the vectors.
+         * @param rowIndices Pointer to the indices of the rows to query or `nullptr` to query the rows `0, ..., nRows - 1`.
+         * @param nRows The number of rows to query.
+         * @param regions Output array of size `nRows`, which receives the region of every queried row.
+         * @param workerCount Number of workers to consider.
+         */
+        void findRegions(const RowMatrixXRef<T>& dataset, const unsigned int* rowIndices, size_t nRows, unsigned int* regions, unsigned int workerCount) const {
+            if (static_cast<std::uint64_t>(dataset.cols()) != _nDimensions)
+                throw std::runtime_error("LeafIndex::findRegions: The dataset needs to have " + std::to_string(_nDimensions) + " columns.");
+
+            const LeafSearch<T> search = getSearch();
+            const long blockSize = 256;
+            const long nBlocks = static_cast<long>((nRows + blockSize - 1) / blockSize);
+
+#pragma omp parallel num_threads(workerCount)
+            {
+                RowMatrixX<T> blockRows;
+                std::vector<unsigned int> leaves(blockSize);
+                std::vector<T> sqDistances(blockSize);
+
+#pragma omp for schedule(static)
+                for (long b = 0; b < nBlocks; b++) {
+                    const long blockBegin = b * blockSize;
+                    const long blockRowCount = std::min<long>(blockSize, static_cast<long>(nRows) - blockBegin);
+
+                    // Consecutive rows of a densely packed dataset can be searched in place, all other rows are gathered first.
+                    const T* blockData = dataset.data() + blockBegin * dataset.outerStride();
+                    if (rowIndices != nullptr || dataset.outerStride() != dataset.cols()) {
+                        blockRows.resize(blockSize, dataset.cols());
+                        for (long i = 0; i < blockRowCount; i++)
+                            blockRows.row(i) = dataset.row(rowIndices == nullptr ? blockBegin + i : rowIndices[blockBegin + i]);
+                        blockData = blockRows.data();
+                    }
+
+                    search.findLeaves(blockData, blockRowCount, leaves.data(), sqDistances.data());
+                    for (long i = 0; i < blockRowCount; i++)
+                        regions[blockBegin + i] = _regions[leaves[i]];
+                }
+            }
+        }
+
+        /**
+         * Returns the search method.
+         * @return As stated above.
+         */
+        LeafSearchMethod getMethod() const {
+            return _method;
+        }
+
+        /**
+         * Returns the number of leaves.
+         * @return As stated above.
+         */
+        std::uint64_t getNumberOfLeaves() const {
+            return _nLeaves;
+        }
+
+        /**
+         * Returns the number of dimensions of the leaf vectors.
+         * @return As stated above.
+         */
+        std::uint64_t getNumberOfDimensions() const {
+            return _nDimensions;
+        }
+
+        /**
+         * Returns the number of search tree nodes (zero for brute force search).
+         * @return As stated above.
+         */
+        std::uint64_t getNumberOfNodes() const {
+            return _splitValues.size();
+        }
+
+    private:
+        static const std::uint64_t _minSearchTreeLeaves = 256;
+        static const unsigned int _bucketSize = 8;
+
+        LeafSearchMethod _method = LeafSearchMethod::BruteForce;
+        std::uint64_t _nLeaves = 0;
+        std::uint64_t _nDimensions = 0;
+        std::uint64_t _stride = 0;
+        std::vector<T, Eigen::aligned_allocator<T>> _leafValues;
+        std::vector<std::uint32_t> _regions;
+        std::vector<T> _splitValues;
+        std::vector<std::int32_t> _splitDimensions;
+        std::vector<std::uint32_t> _first;
+        std::vector<std::uint32_t> _second;
+
+        /**
+         * Recursively builds a k-d tree over the leaves given by `permutation[begin, end)`, whereas nodes are split at the median of the dimension with the largest spread.
+         * @return The index of the created node.
+         */
+        std::uint32_t buildSearchTree(const MatrixX<T>& leaves, std::vector<unsigned int>& permutation, unsigned int begin, unsigned int end) {
+            const auto nodeIdx = static_cast<std::uint32_t>(_splitValues.size());
+            _splitValues.push_back(0.0);
+            _splitDimensions.push_back(-1);
+            _first.push_back(begin);
+            _second.push_back(end);
+            if (end - begin <= _bucketSize)
+                return nodeIdx;
+
+            // Find the dimension with the largest spread.
+            Eigen::Index splitDimension = 0;
+            T largestSpread = -1.0;
+            for (Eigen::Index j = 0; j < leaves.cols(); j++) {
+                T minValue = std::numeric_limits<T>::max();
+                T maxValue = std::numeric_limits<T>::lowest();
+                for (unsigned int i = begin; i < end; i++) {
+                    minValue = std::min(minValue, leaves(permutation[i], j));
+                    maxValue = std::max(maxValue, leaves(permutation[i], j));
+                }
+                if (maxValue - minValue > largestSpread) {
+                    largestSpread = maxValue - minValue;
+                    splitDimension = j;
+                }
+            }
+
+            // Split at the median.
+            const unsigned int middle = begin + (end - begin) / 2;
+            std::nth_element(permutation.begin() + begin, permutation.begin() + middle, permutation.begin() + end,
+                             [&](unsigned int a, unsigned int b) { return leaves(a, splitDimension) < leaves(b, splitDimension); });
+            const T splitValue = leaves(permutation[middle], splitDimension);
+            const std::uint32_t left = buildSearchTree(leaves, permutation, begin, middle);
+            const std::uint32_t right = buildSearchTree(leaves, permutation, middle, end);
+
+            _splitValues[nodeIdx] = splitValue;
+            _splitDimensions[nodeIdx] = static_cast<std::int32_t>(splitDimension);
+            _first[nodeIdx] = left;
+            _second[nodeIdx] = right;
+            return nodeIdx;
+        }
+    };
+}
+
+#endif // GENIF_LEAFINDEX_H
@@ -0,0 +1,152 @@
+#ifndef GENIF_PARTITIONING_H
+#define GENIF_PARTITIONING_H
+
+#include <algorithm>
+#include <genif/io/DataTypeHandling.h>
+#include <vector>
+
+namespace genif {
+    /**
+     * Provides lock-free routines to group labelled vectors into clusters.
+     *
+     * The labels are split into contiguous chunks (one per worker). Every chunk is counted into its own histogram, the histograms are combined by a prefix sum and every chunk
+     * finally scatters its elements to their target positions. Since chunks retain their order, the result is deterministic and stable regardless of the number of workers.
+     */
+    class Partitioning {
+    public:
+        /**
+         * Counts, how often each label occurs.
+         * @param labels Pointer to the labels. Every label needs to be less than `nLabels`.
+         * @param n The number of labels.
+         * @param nLabels The number of distinct labels.
+         * @param workerCount Number of workers to consider.
+         * @return A vector of size `nLabels` holding the number of occurrences of each label.
+         */
+        static std::vector<unsigned long> histogram(const unsigned int* labels, size_t n, unsigned int nLabels, unsigned int workerCount) {
+            const unsigned int nChunks = chunkCount(n, workerCount);
+            if (nChunks == 1) {
+                std::vector<unsigned long> counts(nLabels, 0);
+                for (size_t i = 0; i < n; i++)
+                    counts[labels[i]]++;
+                return counts;
+            }
+
+            std::vector<std::vector<unsigned long>> chunkCounts(nChunks, std::vector<unsigned long>(nLabels, 0));
+
+#pragma omp parallel for schedule(static, 1) num_threads(workerCount)
+            for (unsigned int c = 0; c < nChunks; c++) {
+                auto& counts = chunkCounts[c];
+                for (size_t i = chunkBegin(c, n, nChunks); i < chunkBegin(c + 1, n, nChunks); i++)
+                    counts[labels[i]]++;
+            }
+
+            std::vector<unsigned long> counts(nLabels, 0);
+            for (auto& chunk : chunkCounts)
+                for (unsigned int j = 0; j < nLabels; j++)
+                    counts[j] += chunk[j];
+            return counts;
+        }
+
+        /**
+         * Groups elements by their labels, i.e. elements with label 0 come first, then elements with label 1 and so forth. Elements with equal labels keep their relative order.
+         * @param labels Pointer to the labels. Every label needs to be less than `nLabels`.
+         * @param n The number of labels.
+         * @param nLabels The number of distinct labels.
+         * @param workerCount Number of workers to consider.
+         * @param indicesIn Vector indices to partition (`n` entries).
+         * @param sqDistancesIn Squared distances to partition alongside the indices (`n` entries).
+         * @param indicesOut Output array for the partitioned indices (`n` entries, must not overlap with `indicesIn`).
+         * @param sqDistancesOut Output array for the partitioned squared distances (`n` entries, must not overlap with `sqDistancesIn`).
+         * @return A vector of size `nLabels + 1`, whose entries `i` and `i + 1` enclose the output range of label `i`.
+         */
+        template<typename T>
+        static std::vector<size_t> partition(const unsigned int* labels, size_t n, unsigned int nLabels, unsigned int workerCount, const unsigned int* indicesIn,
+                                             const T* sqDistancesIn, unsigned int* indicesOut, T* sqDistancesOut) {
+            const unsigned int nChunks = chunkCount(n, workerCount);
+            if (nChunks == 1)
+                return partitionSequential(labels, n, nLabels, indicesIn, sqDistancesIn, indicesOut, sqDistancesOut);
+
+            std::vector<std::vector<size_t>> chunkOffsets(nChunks, std::vector<size_t>(nLabels, 0));
+
+#pragma omp parallel num_threads(workerCount)
+            {
+                // Count labels per chunk.
+#pragma omp for schedule(static, 1)
+                for (unsigned int c = 0; c < nChunks; c++) {
+                    auto& counts = chunkOffsets[c];
+                    for (size_t i = chunkBegin(c, n, nChunks); i < chunkBegin(c + 1, n, nChunks); i++)
+                        counts[labels[i]]++;
+                }
+
+                // Turn the counts into output offsets (label-major, then chunk order).
+#pragma omp single
+                {
+                    size_t offset = 0;
+                    for (unsigned int j = 0; j < nLabels; j++) {
+                        for (unsigned int c = 0; c < nChunks; c++) {
+                            const size_t count = chunkOffsets[c][j];
+                            chunkOffsets[c][j] = offset;
+                            offset += count;
+                        }
+                    }
+                }
+
+                // Scatter elements to their target positions.
+#pragma omp for schedule(static, 1)
+                for (unsigned int c = 0; c < nChunks; c++) {
+                    auto& offsets = chunkOffsets[c];
+                    for (size_t i = chunkBegin(c, n, nChunks); i < chunkBegin(c + 1, n, nChunks); i++) {
+                        const size_t target = offsets[labels[i]]++;
+                        indicesOut[target] = indicesIn[i];
+                        sqDistancesOut[target] = sqDistancesIn[i];
+                    }
+                }
+            }
+
+            // After scattering, the offsets of the last chunk point to the end of each label range.
+            std::vector<size_t> labelOffsets(nLabels + 1, 0);
+            for (unsigned int j = 0; j < nLabels; j++)
+                labelOffsets[j + 1] = chunkOffsets[nChunks - 1][j];
+            return labelOffsets;
+        }
+
+    private:
+        /**
+         * Sequential counterpart of `partition`, which is used for inputs, that are too small to be split into chunks.
+         */
+        template<typename T>
+        static std::vector<size_t> partitionSequential(const unsigned int* labels, size_t n, unsigned int nLabels, const unsigned int* indicesIn, const T* sqDistancesIn,
+                                                       unsigned int* indicesOut, T* sqDistancesOut) {
+            std::vector<size_t> labelOffsets(nLabels + 1, 0);
+            for (size_t i = 0; i < n; i++)
+                labelOffsets[labels[i] + 1]++;
+            for (unsigned int j = 0; j < nLabels; j++)
+                labelOffsets[j + 1] += labelOffsets[j];
+
+            std::vector<size_t> offsets(labelOffsets.begin(), labelOffsets.end() - 1);
+            for (size_t i = 0; i < n; i++) {
+                const size_t target = offsets[labels[i]]++;
+                indicesOut[target] = indicesIn[i];
+                sqDistancesOut[target] = sqDistancesIn[i];
+            }
+            return labelOffsets;
+        }
+
+        /**
+         * Returns the number of chunks to split `n` elements into. Very small inputs are not split at all.
+         */
+        static unsigned int chunkCount(size_t n, unsigned int workerCount) {
+            const size_t minChunkSize = 1024;
+            return static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(workerCount, n / minChunkSize)));
+        }
+
+        /**
+         * Returns the first element of chunk `c`.
+         */
+        static size_t chunkBegin(unsigned int c, size_t n, unsigned int nChunks) {
+            return n * c / nChunks;
+        }
+    };
+}
+
+#endif // GENIF_PARTITIONING_H
@@ -1,26 +1,101 @@
 #ifndef GENIF_TREE_H
 #define GENIF_TREE_H
 
+#include <cstdint>
 #include <genif/io/DataTypeHandling.h>
+#include <limits>
+#include <vector>
 
 namespace genif {
+    /**
+     * A single node of a Tree. Nodes do not own any vectors but refer to a contiguous range of the index array, which is shared by the whole tree.
+     */
+    struct TreeNode {
+        unsigned int begin = 0; // The first position of the node's vectors in Tree::vectorIndices.
+        unsigned int end = 0; // One past the last position of the node's vectors in Tree::vectorIndices.
+        unsigned int representativeIndex = 0; // The vector index (see Tree::vectorIndices) of the representative vector of this node.
+        unsigned int firstChild = 0; // The position of the first child in Tree::nodes (children are stored contiguously).
+        unsigned int childCount = 0; // The number of children (zero for leaves).
+        unsigned int depth = 0; // The distance to the root node.
+        std::uint64_t seed = 0; // The seed of the node's own random number stream.
+        unsigned int exitRank = 0; // The number of thresholds of a family fit, which the exit condition applies for (see GeneralizedIsolationTree::fitFamily).
+
+        /**
+         * Returns the number of vectors included in that node.
+         * @return As stated above.
+         */
+        unsigned int size() const {
+            return end - begin;
+        }
+
+        /**
+         * Returns, whether this node is a leaf.
+         * @return As stated above.
+         */
+        bool isLeaf() const {
+            return childCount == 0;
+        }
+    };
+
+    /**
+     * A tree, whose nodes are kept in a single pool. Splitting a node partitions its range of the shared index array in place, such that every child again owns a contiguous
+     * sub-range.
+     *
+     * The tree is induced from a subset of the dataset rows, which is given by `rowIndices` (rows may occur multiple times, e.g. when sampling with replacement). Vector
+     * indices refer to positions in `rowIndices`, so that the dataset is never copied.
+     *
+     * @tparam T The scalar type of the dataset (float or double).
+     */
+    template<typename T>
     struct Tree {
         // Tree structure.
-        std::vector<Tree*> nodes;
-        Tree* parent;
+        std::vector<TreeNode> nodes; // The node pool, the root node is stored at position zero.
 
         // Tree data.
-        const MatrixX& dataset;
-        std::vector<unsigned int> vectorIndices; // The indices of the vectors included in that node.
-        unsigned int representativeIndex; // The index of the representative vector of this node.
+        RowMatrixXRef<T> dataset; // A view on the dataset, whose data needs to outlive the tree.
+        std::vector<unsigned int> rowIndices; // The dataset rows, which the tree is induced from.
+        std::vector<unsigned int> vectorIndices; // The indices of the vectors (i.e. positions in rowIndices), grouped by node.
+        std::vector<T> representativeSqDistances; // The squared distances of the vectors to the representative of their node (same order as vectorIndices).
 
-        Tree(const MatrixX& dataset) : dataset(dataset) {
+        Tree(const RowMatrixXRef<T>& dataset, std::vector<unsigned int> rowIndices) : dataset(dataset), rowIndices(std::move(rowIndices)) {
             // Constructor.
         }
 
-        virtual ~Tree() {
-            for (auto& node : nodes)
-                delete node;
+        /**
+         * Returns the dataset row of a vector.
+         * @param vectorIndex The index of the vector.
+         * @return As stated above.
+         */
+        typename RowMatrixXRef<T>::ConstRowXpr row(unsigned int vectorIndex) const {
+            return dataset.row(rowIndices[vectorIndex]);
+        }
+
+        /**
+         * Returns the dataset row indices of the representatives of all leaves in depth-first order. The order only depends on the tree structure and not on the order, in
+         * which nodes have been added to the pool.
+         *
+         * Trees, which have been induced for a family of thresholds, contain the trees of all smaller thresholds. The tree of the i-th threshold is obtained by treating every
+         * node, whose exit rank exceeds i, as leaf.
+         *
+         * @param familyIndex The index of the threshold within the family (the default yields the leaves of the whole tree).
+         * @return As stated above.
+         */
+        std::vector<unsigned int> getLeafRepresentatives(unsigned int familyIndex = std::numeric_limits<unsigned int>::max()) const {
+            std::vector<unsigned int> leafRepresentatives;
+            if (nodes.empty())
+                return leafRepresentatives;
+
+            std::vector<unsigned int> stack = {0};
+            while (!stack.empty()) {
+                const TreeNode& node = nodes[stack.back()];
+                stack.pop_back();
+                if (node.isLeaf() || node.exitRank > familyIndex)
+                    leafRepresentatives.push_back(rowIndices[node.representativeIndex]);
+                else
+                    for (unsigned int i = node.childCount; i > 0; i--)
+                        stack.push_back(node.firstChild + i - 1);
+            }
+            return leafRepresentatives;
         }
     };
 }
@@ -1,15 +1,30 @@
 #ifndef GENIF_DATATYPEHANDLING_H_
 #define GENIF_DATATYPEHANDLING_H_
 
+// genif schedules its workers on its own, hence Eigen must not open parallel regions of its own.
+#ifndef EIGEN_DONT_PARALLELIZE
+#define EIGEN_DONT_PARALLELIZE
+#endif
+
 #include "Eigen/Eigen"
 #include <cfloat>
 #include <memory>
 
 namespace genif {
-    typedef double data_t;
-    typedef Eigen::MatrixXd MatrixX;
-    typedef Eigen::VectorXd VectorX;
-    typedef Eigen::Ref<VectorX, 0, Eigen::InnerStride<>> VectorXRef;
+    // All learners, models and kernels are templated on the scalar type T of the data (float or double). The following aliases give the Eigen types for a scalar type.
+    template<typename T>
+    using MatrixX = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+    template<typename T>
+    using VectorX = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+    template<typename T>
+    using VectorXRef = Eigen::Ref<VectorX<T>, 0, Eigen::InnerStride<>>;
+
+    // Datasets are stored row by row, such that every observation is contiguous in memory. A RowMatrixXRef maps row-major data (e.g. a C-contiguous NumPy array) without
+    // copying it. Other matrices, e.g. column-major ones, are converted into a temporary row-major copy once, when they are bound to a RowMatrixXRef.
+    template<typename T>
+    using RowMatrixX = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    template<typename T>
+    using RowMatrixXRef = Eigen::Ref<const RowMatrixX<T>>;
 }
 
 #endif
@@ -0,0 +1,98 @@
+#ifndef GENIF_MAPPEDFILE_H
+#define GENIF_MAPPEDFILE_H
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GENIF_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace genif {
+    /**
+     * A read-only view on the contents of a file. On POSIX systems, the file is memory-mapped, such that all processes, which map the same file, share its pages in
+     * the page cache. On other systems, the file is read into an owned buffer. In both cases, the contents are aligned to at least 8 bytes.
+     */
+    class MappedFile {
+    public:
+        /**
+         * Maps (or reads) a file.
+         * @param path The path of the file.
+         */
+        explicit MappedFile(const std::string& path) {
+#ifdef GENIF_HAVE_MMAP
+            const int descriptor = ::open(path.c_str(), O_RDONLY);
+            if (descriptor < 0)
+                throw std::runtime_error("MappedFile::MappedFile: Could not open '" + path + "'.");
+            struct stat status;
+            if (::fstat(descriptor, &status) != 0) {
+                ::close(descriptor);
+                throw std::runtime_error("MappedFile::MappedFile: Could not determine the size of '" + path + "'.");
+            }
+            _size = static_cast<std::uint64_t>(status.st_size);
+            if (_size > 0) {
+                void* mapping = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, descriptor, 0);
+                if (mapping == MAP_FAILED) {
+                    ::close(descriptor);
+                    throw std::runtime_error("MappedFile::MappedFile: Could not map '" + path + "'.");
+                }
+                _data = static_cast<const unsigned char*>(mapping);
+            }
+            // The mapping stays valid after closing the descriptor.
+            ::close(descriptor);
+#else
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file)
+                throw std::runtime_error("MappedFile::MappedFile: Could not open '" + path + "'.");
+            _size = static_cast<std::uint64_t>(file.tellg());
+            _buffer.resize((_size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+            file.seekg(0);
+            if (!file.read(reinterpret_cast<char*>(_buffer.data()), _size))
+                throw std::runtime_error("MappedFile::MappedFile: Could not read '" + path + "'.");
+            _data = reinterpret_cast<const unsigned char*>(_buffer.data());
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() {
+#ifdef GENIF_HAVE_MMAP
+            if (_data != nullptr)
+                ::munmap(const_cast<unsigned char*>(_data), _size);
+#endif
+        }
+
+        /**
+         * Returns a pointer to the contents of the file (nullptr for empty files).
+         * @return As stated above.
+         */
+        const unsigned char* data() const {
+            return _data;
+        }
+
+        /**
+         * Returns the size of the file in bytes.
+         * @return As stated above.
+         */
+        std::uint64_t size() const {
+            return _size;
+        }
+
+    private:
+        const unsigned char* _data = nullptr;
+        std::uint64_t _size = 0;
+#ifndef GENIF_HAVE_MMAP
+        std::vector<std::uint64_t> _buffer;
+#endif
+    };
+}
+
+#endif // GENIF_MAPPEDFILE_H
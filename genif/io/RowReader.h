@@ -0,0 +1,155 @@
+#ifndef GENIF_ROWREADER_H
+#define GENIF_ROWREADER_H
+
+#include "DataTypeHandling.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace genif {
+    /**
+     * A source of dataset rows, which are consumed chunk by chunk, e.g. for scoring datasets, which do not fit into memory (see CompiledForest::predict).
+     * @tparam T The scalar type of the rows (float or double).
+     */
+    template<typename T>
+    class RowReader {
+    public:
+        static const std::uint64_t unknownNumberOfRows = ~std::uint64_t(0); // Returned by `getNumberOfRows`, if the source does not know its number of rows.
+
+        /**
+         * Returns the number of columns of every row.
+         * @return As stated above.
+         */
+        virtual unsigned long getNumberOfColumns() const = 0;
+
+        /**
+         * Reads the next rows.
+         * @param rows Pointer to a buffer, which receives up to `maxRows` rows (row-major, `getNumberOfColumns()` entries per row).
+         * @param maxRows The maximum number of rows to read.
+         * @return The number of rows, which have been read. Less than `maxRows` rows are only returned, if the source is exhausted.
+         */
+        virtual unsigned long read(T* rows, unsigned long maxRows) = 0;
+
+        /**
+         * Returns the total number of rows of the source, if known.
+         * @return As stated above, or `unknownNumberOfRows`.
+         */
+        virtual std::uint64_t getNumberOfRows() const {
+            return unknownNumberOfRows;
+        }
+
+        /**
+         * Skips the next rows. By default, the rows are read and discarded.
+         * @param nRows The number of rows to skip.
+         */
+        virtual void skip(std::uint64_t nRows) {
+            RowMatrixX<T> discarded(std::min<std::uint64_t>(nRows, 4096), getNumberOfColumns());
+            for (unsigned long nRead = 1; nRows > 0 && nRead > 0; nRows -= nRead)
+                nRead = read(discarded.data(), std::min<std::uint64_t>(nRows, discarded.rows()));
+        }
+
+        /**
+         * Destructor.
+         */
+        virtual ~RowReader() = default;
+    };
+
+    template<typename T>
+    const std::uint64_t RowReader<T>::unknownNumberOfRows;
+
+    /**
+     * Reads the rows of an in-memory (or memory-mapped) dataset. Every chunk is copied into the buffer of the caller, which is when the pages of a memory-mapped dataset
+     * are actually read.
+     * @tparam T The scalar type of the rows (float or double).
+     */
+    template<typename T>
+    class MatrixRowReader : public RowReader<T> {
+    public:
+        /**
+         * Creates a reader.
+         * @param dataset The dataset to read. Its data needs to outlive the reader.
+         */
+        explicit MatrixRowReader(const RowMatrixXRef<T>& dataset) : _dataset(dataset) {
+        }
+
+        unsigned long getNumberOfColumns() const override {
+            return _dataset.cols();
+        }
+
+        unsigned long read(T* rows, unsigned long maxRows) override {
+            const unsigned long nRows = std::min<unsigned long>(maxRows, _dataset.rows() - _position);
+            Eigen::Map<RowMatrixX<T>>(rows, nRows, _dataset.cols()) = _dataset.middleRows(_position, nRows);
+            _position += nRows;
+            return nRows;
+        }
+
+        std::uint64_t getNumberOfRows() const override {
+            return _dataset.rows();
+        }
+
+        void skip(std::uint64_t nRows) override {
+            _position += std::min<std::uint64_t>(nRows, _dataset.rows() - _position);
+        }
+
+    private:
+        RowMatrixXRef<T> _dataset;
+        unsigned long _position = 0;
+    };
+
+    /**
+     * Reads the rows of a raw binary file, which stores the rows one after another in the scalar type and the byte order of the host (e.g. written by NumPy's `tofile`).
+     * @tparam T The scalar type of the rows (float or double).
+     */
+    template<typename T>
+    class BinaryFileRowReader : public RowReader<T> {
+    public:
+        /**
+         * Opens a file.
+         * @param path The path of the file.
+         * @param nColumns The number of columns of every row.
+         * @param offset The number of bytes to skip at the beginning of the file (e.g. a header).
+         */
+        BinaryFileRowReader(const std::string& path, unsigned long nColumns, std::uint64_t offset = 0) :
+            _file(path, std::ios::binary | std::ios::ate), _nColumns(nColumns) {
+            if (!_file)
+                throw std::runtime_error("BinaryFileRowReader::BinaryFileRowReader: Could not open '" + path + "'.");
+            if (_nColumns == 0)
+                throw std::runtime_error("BinaryFileRowReader::BinaryFileRowReader: The number of columns needs to be positive.");
+            const auto size = static_cast<std::uint64_t>(_file.tellg());
+            if (offset > size || (size - offset) % (_nColumns * sizeof(T)) != 0)
+                throw std::runtime_error("BinaryFileRowReader::BinaryFileRowReader: The size of '" + path + "' does not match rows of " + std::to_string(_nColumns)
+                                         + " columns.");
+            _nRows = (size - offset) / (_nColumns * sizeof(T));
+            _file.seekg(offset);
+        }
+
+        unsigned long getNumberOfColumns() const override {
+            return _nColumns;
+        }
+
+        unsigned long read(T* rows, unsigned long maxRows) override {
+            const std::streamsize rowSize = _nColumns * sizeof(T);
+            _file.read(reinterpret_cast<char*>(rows), maxRows * rowSize);
+            if (_file.bad())
+                throw std::runtime_error("BinaryFileRowReader::read: Could not read from the file.");
+            return _file.gcount() / rowSize;
+        }
+
+        std::uint64_t getNumberOfRows() const override {
+            return _nRows;
+        }
+
+        void skip(std::uint64_t nRows) override {
+            _file.seekg(static_cast<std::streamoff>(nRows * _nColumns * sizeof(T)), std::ios::cur);
+        }
+
+    private:
+        std::ifstream _file;
+        unsigned long _nColumns;
+        std::uint64_t _nRows;
+    };
+}
+
+#endif // GENIF_ROWREADER_H
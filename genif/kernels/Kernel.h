@@ -1,9 +1,16 @@
 #ifndef GENIF_KERNEL_H
 #define GENIF_KERNEL_H
 
-#include "Kernel.h"
+#include <algorithm>
+#include <genif/io/DataTypeHandling.h>
+#include <limits>
 
 namespace genif {
+    /**
+     * Provides an interface for kernel functions.
+     * @tparam T The scalar type of the vectors (float or double).
+     */
+    template<typename T>
     class Kernel {
     public:
         /**
@@ -12,13 +19,78 @@ namespace genif {
          * @param x2 A real-valued vector.
          * @return The value of the kernel function k(x1, x2).
          */
-        virtual data_t operator()(const VectorX& x1, const VectorX& x2) const = 0;
+        virtual T operator()(const VectorX<T>& x1, const VectorX<T>& x2) const = 0;
+
+        /**
+         * Returns, whether the kernel function value only depends on the euclidean distance between its arguments. Radial kernels may be evaluated by calling
+         * `fromSquaredDistance` with an already known squared distance, which saves a pass over the input vectors.
+         * @return As stated above.
+         */
+        virtual bool isRadial() const {
+            return false;
+        }
+
+        /**
+         * Returns an upper bound of the kernel function values. Kernel values are assumed to be non-negative, hence they lie in `[0, getMaximumValue()]`. The default
+         * implementation returns infinity, i.e. the kernel values are considered to be unbounded.
+         * @return As stated above.
+         */
+        virtual T getMaximumValue() const {
+            return std::numeric_limits<T>::infinity();
+        }
+
+        /**
+         * Returns the value of the kernel function for two vectors, whose squared euclidean distance is already known. Only available for radial kernels.
+         * @param squaredDistance The squared euclidean distance \f$\|x_1 - x_2\|_2^2\f$.
+         * @return The value of the kernel function k(x1, x2).
+         */
+        virtual T fromSquaredDistance(T squaredDistance) const {
+            throw std::runtime_error("Kernel::fromSquaredDistance: Kernel is not radial.");
+        }
+
+        /**
+         * Returns the sum of the kernel function values between an anchor vector and a set of dataset rows. Kernels should override this method to evaluate whole blocks of
+         * rows at once, the default implementation calls `operator()` for every row.
+         * @param anchor Pointer to the anchor vector (`dataset.cols()` contiguous entries).
+         * @param dataset The dataset, which holds the rows.
+         * @param rowIndices Pointer to the indices of the rows.
+         * @param n The number of rows.
+         * @return The sum \f$\sum_i k(a, x_i)\f$.
+         */
+        virtual T sum(const T* anchor, const RowMatrixXRef<T>& dataset, const unsigned int* rowIndices, size_t n) const {
+            const VectorX<T> x1 = Eigen::Map<const VectorX<T>>(anchor, dataset.cols());
+            T accu = 0.0;
+            for (size_t i = 0; i < n; i++)
+                accu += operator()(x1, dataset.row(rowIndices[i]).transpose());
+            return accu;
+        }
+
+        /**
+         * Returns the sum of the kernel function values for a block of already known squared euclidean distances. Only available for radial kernels.
+         * @param squaredDistances Pointer to the squared distances.
+         * @param n The number of squared distances.
+         * @return The sum \f$\sum_i k(x_i, y_i)\f$, whereas \f$\|x_i - y_i\|_2^2\f$ is given by `squaredDistances[i]`.
+         */
+        virtual T sumFromSquaredDistances(const T* squaredDistances, size_t n) const {
+            T accu = 0.0;
+            for (size_t i = 0; i < n; i++)
+                accu += fromSquaredDistance(squaredDistances[i]);
+            return accu;
+        }
 
         /**
          * Destructor.
          */
         virtual ~Kernel() = default;
+
+    protected:
+        // The number of values, which batch evaluations process at once. Chunks of this size are kept on the stack.
+        static const unsigned int _chunkSize = 64;
+        typedef Eigen::Array<T, Eigen::Dynamic, 1, 0, _chunkSize, 1> Chunk;
     };
+
+    template<typename T>
+    const unsigned int Kernel<T>::_chunkSize;
 }
 
 #endif // GENIF_KERNEL_H
@@ -6,20 +6,26 @@
 namespace genif {
     /**
      * Provides an implementation of the Matern kernel.
+     * @tparam T The scalar type of the vectors (float or double).
+     * @tparam D Twice the smoothness parameter \f$\nu\f$ (1, 3 or 5). Since D is known at compile time, the kernel function is specialized for every supported value.
      */
-    class MaternKernel : public Kernel {
+    template<typename T, unsigned int D = 3>
+    class MaternKernel final : public Kernel<T> {
+        static_assert(D == 1 || D == 3 || D == 5, "MaternKernel: Only D=1 or D=3 or D=5 is supported.");
+
     public:
-        using Kernel::operator();
+        using Kernel<T>::operator();
 
         /**
          * Instantiates the Matern kernel.
          * @param Sigma The scaling vector, which needs to hold as many entries as the vectors you want to compute the kernel function value with.
-         * @param d
-         * @param l
+         * @param l A scaling value.
          */
-        explicit MaternKernel(VectorX Sigma, unsigned int d = 3, data_t l = 1.0) : _d(d), _l(l), _Sigma(std::move(Sigma)) {
-            if (!(d == 1 || d == 3 || d == 5))
-                throw std::runtime_error("MaternKernel::MaternKernel: Only d=1 or d=3 or d=5 is supported.");
+        explicit MaternKernel(VectorX<T> Sigma, T l = 1.0) : _l(l), _Sigma(std::move(Sigma)) {
+            _isRadial = _Sigma.size() > 0 && (_Sigma.array() == _Sigma[0]).all();
+            _inverseSigma = _Sigma.cwiseInverse();
+            _l2 = _l * _l;
+            _sqrtD = std::sqrt(static_cast<T>(D));
         }
 
         /**
@@ -28,26 +34,81 @@ namespace genif {
          * @param x2 A real-valued vector.
          * @return The Matern kernel function value \f$k(\vec{x}_1, \vec{x}_1)\f$.
          */
-        data_t operator()(const VectorX& x1, const VectorX& x2) const override {
+        T operator()(const VectorX<T>& x1, const VectorX<T>& x2) const override {
             if (_Sigma.size() != x1.size() || _Sigma.size() != x2.size())
                 throw std::runtime_error("MaternKernel::operator(): The scaling vector size does not conform to the input vector dimensionalities.");
-            VectorX x1Scaled = x1;
-            VectorX x2Scaled = x2;
-            for (unsigned int i = 0; i < _Sigma.size(); i++) {
-                x1Scaled[i] = x1Scaled[i] / _Sigma[i];
-                x2Scaled[i] = x2Scaled[i] / _Sigma[i];
-            }
+            return fromScaledDistance((x1 - x2).cwiseProduct(_inverseSigma).norm());
+        }
 
-            data_t K = (x1Scaled - x2Scaled).norm() * sqrt(_d);
+        /**
+         * The Matern kernel is radial, if all entries of the scaling vector are equal.
+         * @return As stated above.
+         */
+        bool isRadial() const override {
+            return _isRadial;
+        }
 
-            if (_d == 1)
-                return pow(_l, 2.0) * exp(-K);
-            else if (_d == 3)
-                return pow(_l, 2.0) * (1.0 + K) * std::exp(-K);
-            else if (_d == 5)
-                return pow(_l, 2.0) * (1.0 + K + pow(K, 2.0) / 3.0) * exp(-K);
-            else
-                throw std::runtime_error("MaternKernel::operator(): Only d=1 or d=3 or d=5 is supported.");
+        /**
+         * Returns the maximum value of the Matern kernel, i.e. \f$l^2\f$, which is attained for identical vectors.
+         * @return As stated above.
+         */
+        T getMaximumValue() const override {
+            return _l2;
+        }
+
+        /**
+         * Computes the Matern kernel function value for two vectors, whose squared euclidean distance is already known. Only available, if the kernel is radial.
+         * @param squaredDistance The squared euclidean distance \f$\|\vec{x}_1 - \vec{x}_2\|_2^2\f$.
+         * @return The Matern kernel function value \f$k(\vec{x}_1, \vec{x}_1)\f$.
+         */
+        T fromSquaredDistance(T squaredDistance) const override {
+            if (!_isRadial)
+                throw std::runtime_error("MaternKernel::fromSquaredDistance: The scaling vector needs to hold equal entries.");
+            return fromScaledDistance(std::sqrt(squaredDistance) / _Sigma[0]);
+        }
+
+        /**
+         * Returns the sum of the Matern kernel values between an anchor vector and a set of dataset rows. The scaled distances are computed for a chunk of rows at once by
+         * using the precomputed inverse scales, the kernel function is then evaluated vectorized for the whole chunk.
+         * @param anchor Pointer to the anchor vector (`dataset.cols()` contiguous entries).
+         * @param dataset The dataset, which holds the rows.
+         * @param rowIndices Pointer to the indices of the rows.
+         * @param n The number of rows.
+         * @return The sum of the Matern kernel values.
+         */
+        T sum(const T* anchor, const RowMatrixXRef<T>& dataset, const unsigned int* rowIndices, size_t n) const override {
+            if (_Sigma.size() != dataset.cols())
+                throw std::runtime_error("MaternKernel::sum: The scaling vector size does not conform to the input vector dimensionalities.");
+            const Eigen::Map<const Eigen::Matrix<T, 1, Eigen::Dynamic>> x1(anchor, dataset.cols());
+            typename Kernel<T>::Chunk scaledDistances;
+            T accu = 0.0;
+            for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += Kernel<T>::_chunkSize) {
+                const auto chunkLength = static_cast<Eigen::Index>(std::min<size_t>(Kernel<T>::_chunkSize, n - chunkBegin));
+                scaledDistances.resize(chunkLength);
+                for (Eigen::Index i = 0; i < chunkLength; i++)
+                    scaledDistances[i] = (dataset.row(rowIndices[chunkBegin + i]) - x1).cwiseProduct(_inverseSigma.transpose()).norm();
+                accu += sumFromScaledDistances(scaledDistances);
+            }
+            return accu;
+        }
+
+        /**
+         * Returns the sum of the Matern kernel values for a block of already known squared euclidean distances. Only available, if the kernel is radial.
+         * @param squaredDistances Pointer to the squared distances.
+         * @param n The number of squared distances.
+         * @return The sum of the Matern kernel values.
+         */
+        T sumFromSquaredDistances(const T* squaredDistances, size_t n) const override {
+            if (!_isRadial)
+                throw std::runtime_error("MaternKernel::sumFromSquaredDistances: The scaling vector needs to hold equal entries.");
+            typename Kernel<T>::Chunk scaledDistances;
+            T accu = 0.0;
+            for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += Kernel<T>::_chunkSize) {
+                const auto chunkLength = static_cast<Eigen::Index>(std::min<size_t>(Kernel<T>::_chunkSize, n - chunkBegin));
+                scaledDistances = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>(squaredDistances + chunkBegin, chunkLength).sqrt() * _inverseSigma[0];
+                accu += sumFromScaledDistances(scaledDistances);
+            }
+            return accu;
         }
 
         /**
@@ -55,14 +116,14 @@ namespace genif {
          * @return As stated above.
          */
         unsigned int getD() const {
-            return _d;
+            return D;
         }
 
         /**
          * Returns the `L` property of this Matern kernel instance.
          * @return As stated above.
          */
-        data_t getL() const {
+        T getL() const {
             return _l;
         }
 
@@ -70,14 +131,48 @@ namespace genif {
          * Returns the scaling vector of this Matern kernel instance.
          * @return As stated above.
          */
-        const VectorX& getSigma() const {
+        const VectorX<T>& getSigma() const {
             return _Sigma;
         }
 
     private:
-        unsigned int _d = 3;
-        data_t _l = 1.0;
-        VectorX _Sigma;
+        T _l = 1.0;
+        T _l2 = 1.0;
+        T _sqrtD = 1.0;
+        VectorX<T> _Sigma;
+        VectorX<T> _inverseSigma;
+        bool _isRadial = false;
+
+        /**
+         * Computes the Matern kernel function value from the euclidean distance of two already scaled vectors.
+         * @param scaledDistance The euclidean distance of the scaled vectors.
+         * @return The Matern kernel function value.
+         */
+        T fromScaledDistance(T scaledDistance) const {
+            const T K = scaledDistance * _sqrtD;
+
+            if (D == 1)
+                return _l2 * std::exp(-K);
+            else if (D == 3)
+                return _l2 * (1 + K) * std::exp(-K);
+            else
+                return _l2 * (1 + K + K * K / 3) * std::exp(-K);
+        }
+
+        /**
+         * Computes the sum of the Matern kernel function values for a chunk of euclidean distances of already scaled vectors.
+         * @param scaledDistances The euclidean distances of the scaled vectors.
+         * @return The sum of the Matern kernel function values.
+         */
+        T sumFromScaledDistances(const typename Kernel<T>::Chunk& scaledDistances) const {
+            const typename Kernel<T>::Chunk K = scaledDistances * _sqrtD;
+            if (D == 1)
+                return _l2 * (-K).exp().sum();
+            else if (D == 3)
+                return _l2 * ((T(1) + K) * (-K).exp()).sum();
+            else
+                return _l2 * ((T(1) + K + K.square() / T(3)) * (-K).exp()).sum();
+        }
     };
 }
 
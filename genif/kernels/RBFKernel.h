@@ -4,9 +4,14 @@
 #include "Kernel.h"
 
 namespace genif {
-    class RBFKernel : public Kernel {
+    /**
+     * Provides an implementation of the RBF kernel.
+     * @tparam T The scalar type of the vectors (float or double).
+     */
+    template<typename T>
+    class RBFKernel final : public Kernel<T> {
     public:
-        using Kernel::operator();
+        using Kernel<T>::operator();
 
         /**
          * The default constructor for this kernel. The sigma value is 1.0.
@@ -17,7 +22,7 @@ namespace genif {
          * Instantiates a RBF Kernel object with given sigma.
          * @param sigma Kernel sigma value.
          */
-        explicit RBFKernel(data_t sigma) : RBFKernel(sigma, 1.0) {
+        explicit RBFKernel(T sigma) : RBFKernel(sigma, 1.0) {
         }
 
         /**
@@ -25,9 +30,10 @@ namespace genif {
          * @param sigma Kernel sigma value.
          * @param l A scaling value.
          */
-        RBFKernel(data_t sigma, data_t l) : _l2(std::pow(l, 2.0)) {
+        RBFKernel(T sigma, T l) : _l2(std::pow(l, 2.0)) {
             _sigma = sigma;
             _denom = 2.0 * std::pow(_sigma, 2.0);
+            _inverseDenom = 1.0 / _denom;
         };
 
         /**
@@ -43,15 +49,73 @@ namespace genif {
          * @param x2 A vector.
          * @return RBF kernel value for x1 and x2.
          */
-        inline data_t operator()(const VectorX& x1, const VectorX& x2) const override {
+        inline T operator()(const VectorX<T>& x1, const VectorX<T>& x2) const override {
             return _l2 * std::exp(-((x1 - x2).squaredNorm()) / _denom);
         }
 
+        /**
+         * The RBF kernel is radial, hence this method always returns true.
+         * @return As stated above.
+         */
+        bool isRadial() const override {
+            return true;
+        }
+
+        /**
+         * Returns the maximum value of the RBF kernel, i.e. \f$l^2\f$, which is attained for identical vectors.
+         * @return As stated above.
+         */
+        T getMaximumValue() const override {
+            return _l2;
+        }
+
+        /**
+         * Returns the RBF kernel value for two vectors, whose squared euclidean distance is already known.
+         * @param squaredDistance The squared euclidean distance \f$\|x_1 - x_2 \|_2^2\f$.
+         * @return RBF kernel value for x1 and x2.
+         */
+        inline T fromSquaredDistance(T squaredDistance) const override {
+            return _l2 * std::exp(-squaredDistance / _denom);
+        }
+
+        /**
+         * Returns the sum of the RBF kernel values between an anchor vector and a set of dataset rows. The squared distances are computed for a chunk of rows at once and are
+         * then passed to `sumFromSquaredDistances`.
+         * @param anchor Pointer to the anchor vector (`dataset.cols()` contiguous entries).
+         * @param dataset The dataset, which holds the rows.
+         * @param rowIndices Pointer to the indices of the rows.
+         * @param n The number of rows.
+         * @return The sum of the RBF kernel values.
+         */
+        T sum(const T* anchor, const RowMatrixXRef<T>& dataset, const unsigned int* rowIndices, size_t n) const override {
+            const Eigen::Map<const Eigen::Matrix<T, 1, Eigen::Dynamic>> x1(anchor, dataset.cols());
+            typename Kernel<T>::Chunk squaredDistances;
+            T accu = 0.0;
+            for (size_t chunkBegin = 0; chunkBegin < n; chunkBegin += Kernel<T>::_chunkSize) {
+                const auto chunkLength = static_cast<Eigen::Index>(std::min<size_t>(Kernel<T>::_chunkSize, n - chunkBegin));
+                squaredDistances.resize(chunkLength);
+                for (Eigen::Index i = 0; i < chunkLength; i++)
+                    squaredDistances[i] = (dataset.row(rowIndices[chunkBegin + i]) - x1).squaredNorm();
+                accu += sumFromSquaredDistances(squaredDistances.data(), chunkLength);
+            }
+            return accu;
+        }
+
+        /**
+         * Returns the sum of the RBF kernel values for a block of already known squared euclidean distances. The exponential function is evaluated vectorized.
+         * @param squaredDistances Pointer to the squared distances.
+         * @param n The number of squared distances.
+         * @return The sum of the RBF kernel values.
+         */
+        T sumFromSquaredDistances(const T* squaredDistances, size_t n) const override {
+            return _l2 * (Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>(squaredDistances, n) * -_inverseDenom).exp().sum();
+        }
+
         /**
          * Returns the sigma value, that is currently stored in this kernel.
          * @return As stated above.
          */
-        data_t getSigma() const {
+        T getSigma() const {
             return _sigma;
         }
 
@@ -59,14 +123,15 @@ namespace genif {
          * Returns the L scaler value, that is currently stored in this kernel.
          * @return As stated above.
          */
-        data_t getL() const {
+        T getL() const {
             return sqrt(_l2);
         }
 
     private:
-        data_t _sigma = 1.0;
-        data_t _denom = 0.0;
-        data_t _l2 = 1.0;
+        T _sigma = 1.0;
+        T _denom = 2.0;
+        T _inverseDenom = 0.5;
+        T _l2 = 1.0;
     };
 }
 
@@ -0,0 +1,102 @@
+#ifndef GENIF_PHILOX_H
+#define GENIF_PHILOX_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace genif {
+    /**
+     * The counter-based pseudo random number generator Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+     *
+     * The n-th block of random numbers is a pure function of the key (seed), the stream id and n. Hence, any number of independent streams can be derived from a single seed
+     * (e.g. one per model of an ensemble), and their output does not depend on the order or on the thread, in which they are consumed. The class satisfies the requirements of
+     * UniformRandomBitGenerator, but `uniformInt` should be preferred to standard library distributions, since its output is identical across platforms.
+     */
+    class Philox {
+    public:
+        typedef std::uint32_t result_type;
+
+        /**
+         * Instantiates the generator for a given seed and stream.
+         * @param seed The seed, which is used as key.
+         * @param stream The id of the stream.
+         */
+        Philox(std::uint64_t seed, std::uint64_t stream) :
+            _key({static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)}),
+            _counter({0, 0, static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32)}) {
+        }
+
+        /**
+         * Returns the next random number and advances the stream.
+         * @return As stated above.
+         */
+        result_type operator()() {
+            if (_position == _block.size()) {
+                _block = generateBlock(_counter, _key);
+                _position = 0;
+                if (++_counter[0] == 0)
+                    ++_counter[1];
+            }
+            return _block[_position++];
+        }
+
+        /**
+         * Returns an unbiased random integer from the range [0, bound) by using Lemire's multiply-and-reject method.
+         * @param bound The exclusive upper bound (needs to be greater than zero).
+         * @return As stated above.
+         */
+        std::uint32_t uniformInt(std::uint32_t bound) {
+            std::uint64_t m = static_cast<std::uint64_t>(operator()()) * bound;
+            auto low = static_cast<std::uint32_t>(m);
+            if (low < bound) {
+                const std::uint32_t threshold = static_cast<std::uint32_t>(-bound) % bound;
+                while (low < threshold) {
+                    m = static_cast<std::uint64_t>(operator()()) * bound;
+                    low = static_cast<std::uint32_t>(m);
+                }
+            }
+            return static_cast<std::uint32_t>(m >> 32);
+        }
+
+        /**
+         * Returns a random 64 bit integer.
+         * @return As stated above.
+         */
+        std::uint64_t next64() {
+            const std::uint64_t low = operator()();
+            return (static_cast<std::uint64_t>(operator()()) << 32) | low;
+        }
+
+        static constexpr result_type min() {
+            return std::numeric_limits<result_type>::min();
+        }
+
+        static constexpr result_type max() {
+            return std::numeric_limits<result_type>::max();
+        }
+
+    private:
+        std::array<std::uint32_t, 2> _key;
+        std::array<std::uint32_t, 4> _counter;
+        std::array<std::uint32_t, 4> _block = {{0, 0, 0, 0}};
+        std::size_t _position = 4;
+
+        /**
+         * Computes the block of random numbers for a given counter and key by applying ten Philox rounds.
+         */
+        static std::array<std::uint32_t, 4> generateBlock(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key) {
+            for (unsigned int round = 0; round < 10; round++) {
+                const std::uint64_t product0 = static_cast<std::uint64_t>(0xD2511F53U) * counter[0];
+                const std::uint64_t product1 = static_cast<std::uint64_t>(0xCD9E8D57U) * counter[2];
+                counter = {{static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0], static_cast<std::uint32_t>(product1),
+                            static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1], static_cast<std::uint32_t>(product0)}};
+                key[0] += 0x9E3779B9U;
+                key[1] += 0xBB67AE85U;
+            }
+            return counter;
+        }
+    };
+}
+
+#endif // GENIF_PHILOX_H
@@ -0,0 +1,66 @@
+#ifndef GENIF_SPLITMIX64_H
+#define GENIF_SPLITMIX64_H
+
+#include <cstdint>
+#include <limits>
+
+namespace genif {
+    /**
+     * A small and fast pseudo random number generator (Steele et al., "Fast splittable pseudorandom number generators"), which satisfies the requirements of
+     * UniformRandomBitGenerator and can thus be used together with the distributions of the standard library.
+     *
+     * Its main purpose is to derive independent random streams from a parent stream (see `split`), e.g. one stream per tree node.
+     */
+    class SplitMix64 {
+    public:
+        typedef std::uint64_t result_type;
+
+        /**
+         * Instantiates the generator with a given seed.
+         * @param seed The seed (i.e. the initial state).
+         */
+        explicit SplitMix64(std::uint64_t seed = 0) : _state(seed) {
+        }
+
+        /**
+         * Returns the next random number and advances the state.
+         * @return As stated above.
+         */
+        result_type operator()() {
+            _state += 0x9E3779B97F4A7C15ULL;
+            return mix(_state);
+        }
+
+        /**
+         * Derives the seed of an independent child stream from a parent seed and the ordinal of the child. The result only depends on the arguments.
+         * @param seed The seed of the parent stream.
+         * @param ordinal The ordinal of the child stream.
+         * @return The seed of the child stream.
+         */
+        static std::uint64_t split(std::uint64_t seed, std::uint64_t ordinal) {
+            return mix(seed ^ mix(ordinal + 0x9E3779B97F4A7C15ULL));
+        }
+
+        static constexpr result_type min() {
+            return std::numeric_limits<result_type>::min();
+        }
+
+        static constexpr result_type max() {
+            return std::numeric_limits<result_type>::max();
+        }
+
+    private:
+        std::uint64_t _state;
+
+        /**
+         * The SplitMix64 output function (a variant of the MurmurHash3 finalizer).
+         */
+        static std::uint64_t mix(std::uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+    };
+}
+
+#endif // GENIF_SPLITMIX64_H